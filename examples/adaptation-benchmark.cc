@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Microbenchmark of the decision cost of the adaptation algorithms
+// - Every algorithm decides on synthetic session histories of growing length, without simulation
+// - Writes one CSV line per algorithm and history length: time and heap allocations per decision
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <new>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "ns3/core-module.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-adaptation-algorithm.h"
+
+static uint64_t g_allocations = 0; //!< Number of heap allocations of the process so far
+
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == NULL)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) throw ()
+{
+  std::free (p);
+}
+
+void *
+operator new[] (std::size_t size)
+{
+  return operator new (size);
+}
+
+void
+operator delete[] (void *p) throw ()
+{
+  operator delete (p);
+}
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("AdaptationBenchmark");
+
+static int64_t g_now = 0; //!< The time in microseconds the algorithms decide at
+static volatile int64_t g_sink = 0; //!< Keeps the compiler from dropping the timed decisions
+
+static int64_t
+BenchmarkClock (void)
+{
+  return g_now;
+}
+
+/**
+ * \return wall clock time in nanoseconds
+ */
+static double
+WallClock (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Fill the data a client hands to its algorithm as if it had downloaded history segments, each one
+ * over a link whose throughput varies randomly around the average bitrate of the middle representation.
+ */
+static void
+BuildHistory (uint32_t history, uint32_t representations, int64_t segmentDuration,
+              videoData &video, playbackData &playback, bufferData &buffer,
+              throughputData &throughput, serverHints &hints)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  // leave room behind the history for algorithms looking ahead
+  uint32_t segments = history + 100;
+  video.segmentDuration = segmentDuration;
+  for (uint32_t i = 0; i < representations; i++)
+    {
+      double bitrate = 300000.0 * pow (2.0, i);
+      std::vector<int64_t> sizes;
+      std::vector<double> qualities;
+      for (uint32_t j = 0; j < segments; j++)
+        {
+          sizes.push_back ((int64_t)(bitrate * random->GetValue (0.7, 1.3) * segmentDuration / 8000000.0));
+          qualities.push_back (std::min (100.0, 40.0 + 10.0 * i + random->GetValue (-5.0, 5.0)));
+        }
+      video.segmentSize.push_back (sizes);
+      video.segmentQuality.push_back (qualities);
+      video.averageBitrate.push_back (bitrate);
+    }
+
+  int64_t time = 0;
+  int64_t level = 0;
+  playback.firstSegmentIndex = 0;
+  for (uint32_t j = 0; j < history; j++)
+    {
+      int64_t rep = (int64_t) random->GetInteger (0, representations - 1);
+      int64_t bytes = video.segmentSize.at (rep).at (j);
+      double rate = video.averageBitrate.at (representations / 2) * random->GetValue (0.5, 2.0);
+      int64_t start = time + 20000;
+      int64_t end = start + (int64_t)(8.0 * bytes / rate * 1000000.0);
+
+      playback.playbackIndex.push_back (rep);
+      throughput.transmissionRequested.push_back (time);
+      throughput.transmissionStart.push_back (start);
+      throughput.transmissionEnd.push_back (end);
+      throughput.bytesReceived.push_back (bytes);
+      throughput.transmissionIdle.push_back (0);
+
+      int64_t levelOld = std::max (level - (end - time), (int64_t)0);
+      level = levelOld + segmentDuration;
+      buffer.timeNow.push_back (end);
+      buffer.bufferLevelOld.push_back (levelOld);
+      buffer.bufferLevelNew.push_back (level);
+      if (j > 0)
+        {
+          playback.playbackStart.push_back (end);
+        }
+
+      hints.timeReceived.push_back (start);
+      hints.activeConnections.push_back (4);
+      hints.fairShare.push_back (rate);
+      hints.egressRate.push_back (4 * rate);
+      time = end;
+    }
+  g_now = time;
+}
+
+int
+main (int argc, char *argv[])
+{
+//
+// Users may find it convenient to turn on explicit debugging
+// for selected modules; the below lines suggest how to do this
+//
+//   LogComponentEnable ("AdaptationBenchmark", LOG_LEVEL_INFO);
+
+  std::string historyLengths = "100,1000,10000,100000";
+  std::string algorithms = "";
+  uint32_t iterations = 1000;
+  uint32_t representations = 6;
+  uint64_t segmentDuration = 2000000;
+  std::string neuralWeights = "";
+  std::string outputFile = dashLogDirectory + "adaptationBenchmark.csv";
+
+  CommandLine cmd;
+  cmd.Usage ("Microbenchmark of the decision cost of the adaptation algorithms.\n");
+  cmd.AddValue ("historyLengths", "Comma separated numbers of segments downloaded before the benchmarked decision", historyLengths);
+  cmd.AddValue ("algorithms", "Comma separated names of the algorithms to benchmark, all registered ones if empty", algorithms);
+  cmd.AddValue ("iterations", "The number of decisions timed per algorithm and history length", iterations);
+  cmd.AddValue ("representations", "The number of representations of the synthetic video", representations);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("neuralWeights", "The weights file of the neural adaptation algorithm, which is skipped if empty", neuralWeights);
+  cmd.AddValue ("outputFile", "The CSV file the results are written to", outputFile);
+  cmd.Parse (argc, argv);
+
+  if (!neuralWeights.empty ())
+    {
+      Config::SetDefault ("ns3::NeuralAlgorithm::WeightsFile", StringValue (neuralWeights));
+    }
+
+  std::vector<uint32_t> lengths;
+  std::stringstream lengthStream (historyLengths);
+  std::string length;
+  while (std::getline (lengthStream, length, ','))
+    {
+      lengths.push_back (std::atoi (length.c_str ()));
+    }
+  std::sort (lengths.begin (), lengths.end ());
+
+  std::vector<std::string> names;
+  if (algorithms.empty ())
+    {
+      // every algorithm is registered under its TypeId name and its short name, only take the short ones
+      std::vector<std::string> registered = AdaptationAlgorithm::GetRegisteredNames ();
+      for (uint32_t i = 0; i < registered.size (); i++)
+        {
+          if (registered.at (i).find ("::") == std::string::npos
+              && (registered.at (i) != "neural" || !neuralWeights.empty ()))
+            {
+              names.push_back (registered.at (i));
+            }
+        }
+    }
+  else
+    {
+      std::stringstream algorithmStream (algorithms);
+      std::string algorithm;
+      while (std::getline (algorithmStream, algorithm, ','))
+        {
+          names.push_back (algorithm);
+        }
+    }
+
+  mkdir (dashLogDirectory.c_str (), 0775);
+  std::ofstream output (outputFile.c_str ());
+  NS_ABORT_MSG_IF (!output.is_open (), "Couldn't open " << outputFile);
+  output << "algorithm,history,iterations,ns_per_decision,allocations_per_decision,relative_to_shortest\n";
+
+  for (uint32_t a = 0; a < names.size (); a++)
+    {
+      double shortest = 0;
+      for (uint32_t l = 0; l < lengths.size (); l++)
+        {
+          videoData video;
+          playbackData playback;
+          bufferData buffer;
+          throughputData throughput;
+          serverHints hints;
+          BuildHistory (lengths.at (l), representations, segmentDuration, video, playback, buffer, throughput, hints);
+
+          Ptr<AdaptationAlgorithm> algo = AdaptationAlgorithm::Create (names.at (a), video, playback, buffer, throughput);
+          NS_ABORT_MSG_IF (algo == 0, "No adaptation algorithm is registered as " << names.at (a));
+          algo->SetClock (MakeCallback (&BenchmarkClock));
+          algo->SetServerHints (&hints);
+
+          // the first decision may fill caches or tables, leave it out
+          algorithmReply answer = algo->GetNextRep (lengths.at (l), 0);
+          g_sink = answer.nextRepIndex;
+
+          uint64_t allocations = g_allocations;
+          double start = WallClock ();
+          for (uint32_t i = 0; i < iterations; i++)
+            {
+              answer = algo->GetNextRep (lengths.at (l), 0);
+              g_sink = g_sink + answer.nextRepIndex;
+            }
+          double nsPerDecision = (WallClock () - start) / iterations;
+          double allocationsPerDecision = (g_allocations - allocations) / (double) iterations;
+          if (l == 0)
+            {
+              shortest = nsPerDecision;
+            }
+
+          output << names.at (a) << "," << lengths.at (l) << "," << iterations << ","
+                 << std::fixed << std::setprecision (1) << nsPerDecision << ","
+                 << std::setprecision (3) << allocationsPerDecision << ","
+                 << std::setprecision (3) << nsPerDecision / shortest << "\n";
+          output.unsetf (std::ios::fixed);
+          NS_LOG_INFO (names.at (a) << " history " << lengths.at (l) << ": " << nsPerDecision << " ns, "
+                                    << allocationsPerDecision << " allocations per decision");
+        }
+    }
+  output.close ();
+  std::cout << "Results written to " << outputFile << "\n";
+  return 0;
+}
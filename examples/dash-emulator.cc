@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Trace-driven emulation of one streaming session per throughput trace
+// - No packet-level simulation, the segments are downloaded at the throughput of the trace
+// - Same log files as the tcp-stream example
+
+#include <fstream>
+#include <sstream>
+#include "ns3/core-module.h"
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/dash-emulator.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DashEmulatorExample");
+
+int
+main (int argc, char *argv[])
+{
+//
+// Users may find it convenient to turn on explicit debugging
+// for selected modules; the below lines suggest how to do this
+//
+//   LogComponentEnable ("DashEmulatorExample", LOG_LEVEL_INFO);
+//   LogComponentEnable ("DashEmulator", LOG_LEVEL_INFO);
+
+  uint64_t segmentDuration = 2000000;
+  uint32_t simulationId = 0;
+  std::string adaptationAlgo;
+  std::string segmentSizeFilePath;
+  std::string traces;
+  double rtt = 0.05;
+
+  CommandLine cmd;
+  cmd.Usage ("Emulation of streaming sessions over throughput traces.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithm that the client uses for the simulation", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("traces", "Comma separated relative paths (from ns-3.x directory) to the throughput traces, one session is emulated per trace", traces);
+  cmd.AddValue ("rtt", "The round trip time in seconds between a request and the first byte of the segment", rtt);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> traceFiles;
+  std::stringstream traceStream (traces);
+  std::string trace;
+  while (std::getline (traceStream, trace, ','))
+    {
+      traceFiles.push_back (trace);
+    }
+  if (traceFiles.empty ())
+    {
+      NS_FATAL_ERROR ("No throughput trace given.");
+    }
+  uint32_t numberOfClients = traceFiles.size ();
+
+  // create the folders the emulators log to
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, 0775);
+  std::string algodirstr (dashLogDirectory +  adaptationAlgo );
+  const char * algodir = algodirstr.c_str();
+  mkdir (algodir, 0775);
+  std::string dirstr (dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/");
+  const char * dir = dirstr.c_str();
+  mkdir(dir, 0775);
+
+  for (uint32_t i = 0; i < numberOfClients; i++)
+    {
+      Ptr<DashEmulator> emulator = CreateObject<DashEmulator> ();
+      emulator->SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+      emulator->SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+      emulator->SetAttribute ("TraceFilePath", StringValue (traceFiles.at (i)));
+      emulator->SetAttribute ("Rtt", TimeValue (Seconds (rtt)));
+      emulator->SetAttribute ("SimulationId", UintegerValue (simulationId));
+      emulator->SetAttribute ("NumberOfClients", UintegerValue (numberOfClients));
+      NS_LOG_INFO ("Emulating trace " << traceFiles.at (i));
+      if (!emulator->Run (adaptationAlgo, i))
+        {
+          NS_FATAL_ERROR ("Emulation of trace " << traceFiles.at (i) << " failed.");
+        }
+    }
+  NS_LOG_INFO ("Done.");
+  return 0;
+}
@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Capacity study with a flow-level (fluid) network model for very large numbers of clients
+// - The clients share one bottleneck, each one limited by its access rate, without packet-level simulation
+// - Hybrid mode: the first packetClients clients stream over TCP through a point-to-point dumbbell instead,
+//   whose bottleneck gets the same share per client as the fluid one, to calibrate the fluid model
+//
+//   fluid:   server ==== bottleneck ==== clients (packetClients ... numberOfClients - 1)
+//   packet:  server ---- router ---- access links ---- clients (0 ... packetClients - 1)
+
+#include <fstream>
+#include <iomanip>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-client.h"
+#include "ns3/fluid-network.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamFluidExample");
+
+int
+main (int argc, char *argv[])
+{
+//
+// Users may find it convenient to turn on explicit debugging
+// for selected modules; the below lines suggest how to do this
+//
+//   LogComponentEnable ("TcpStreamFluidExample", LOG_LEVEL_INFO);
+//   LogComponentEnable ("FluidNetwork", LOG_LEVEL_INFO);
+
+  uint64_t segmentDuration = 2000000;
+  uint32_t simulationId = 0;
+  uint32_t numberOfClients = 1000;
+  uint32_t packetClients = 0;
+  std::string adaptationAlgo = "tobasco";
+  std::string segmentSizeFilePath;
+  std::string bottleneckRate = "1Gb/s";
+  std::string accessRate = "20Mb/s";
+  double rtt = 0.09;
+  double startInterval = 0.03;
+
+  CommandLine cmd;
+  cmd.Usage ("Capacity study with a flow-level network model.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfClients", "The number of clients", numberOfClients);
+  cmd.AddValue ("packetClients", "The number of clients simulated packet-level over TCP, to calibrate the fluid model", packetClients);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithm that the client uses for the simulation", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("bottleneckRate", "The capacity of the bottleneck shared by all clients", bottleneckRate);
+  cmd.AddValue ("accessRate", "The maximum rate of every client, i.e. of its access link", accessRate);
+  cmd.AddValue ("rtt", "The round trip time in seconds between client and server", rtt);
+  cmd.AddValue ("startInterval", "The time in seconds between the starts of two consecutive clients", startInterval);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (packetClients > numberOfClients, "There can not be more packet-level clients than clients");
+  NS_ABORT_MSG_IF (rtt <= 0.004, "The round trip time has to exceed the 4 ms of the packet-level access links");
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  // both kinds of clients get the same share of the bottleneck per client
+  double bottleneckBitRate = DataRate (bottleneckRate).GetBitRate ();
+  uint32_t fluidClients = numberOfClients - packetClients;
+  uint16_t port = 9;
+
+  std::vector <std::pair <Ptr<Node>, std::string> > clients;
+
+  /* Packet-level clients: a dumbbell of point-to-point links */
+  Address serverAddress;
+  NodeContainer packetNodes;
+  if (packetClients > 0)
+    {
+      Ptr<Node> serverNode = CreateObject<Node> ();
+      Ptr<Node> routerNode = CreateObject<Node> ();
+      packetNodes.Create (packetClients);
+
+      PointToPointHelper bottleneckLink;
+      bottleneckLink.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ((uint64_t)(bottleneckBitRate * packetClients / numberOfClients))));
+      bottleneckLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+      bottleneckLink.SetChannelAttribute ("Delay", TimeValue (Seconds (rtt / 2 - 0.002)));
+      NetDeviceContainer bottleneckDevices = bottleneckLink.Install (serverNode, routerNode);
+
+      PointToPointHelper accessLink;
+      accessLink.SetDeviceAttribute ("DataRate", StringValue (accessRate));
+      accessLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+      accessLink.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+      InternetStackHelper stack;
+      stack.Install (serverNode);
+      stack.Install (routerNode);
+      stack.Install (packetNodes);
+
+      Ipv4AddressHelper address;
+      address.SetBase ("76.1.1.0", "255.255.255.0");
+      Ipv4InterfaceContainer bottleneckInterface = address.Assign (bottleneckDevices);
+      serverAddress = Address (bottleneckInterface.GetAddress (0));
+      address.SetBase ("10.0.0.0", "255.255.255.252");
+      for (uint32_t i = 0; i < packetClients; i++)
+        {
+          address.Assign (accessLink.Install (packetNodes.Get (i), routerNode));
+          address.NewNetwork ();
+          clients.push_back (std::make_pair (packetNodes.Get (i), adaptationAlgo));
+        }
+      Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+      TcpStreamServerHelper serverHelper (port);
+      serverHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+      ApplicationContainer serverApp = serverHelper.Install (serverNode);
+      serverApp.Start (Seconds (1.0));
+    }
+
+  /* Fluid clients: no sockets, so they can all live on one node without internet stack */
+  Ptr<FluidNetwork> network = CreateObject<FluidNetwork> ();
+  uint32_t fluidPath = 0;
+  if (fluidClients > 0)
+    {
+      std::vector<uint32_t> links;
+      links.push_back (network->AddLink (DataRate ((uint64_t)(bottleneckBitRate * fluidClients / numberOfClients))));
+      fluidPath = network->AddPath (links, Seconds (rtt), DataRate (accessRate));
+      Ptr<Node> fluidNode = CreateObject<Node> ();
+      for (uint32_t i = 0; i < fluidClients; i++)
+        {
+          clients.push_back (std::make_pair (fluidNode, adaptationAlgo));
+        }
+    }
+
+  // create folder for the logs of the clients
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, 0775);
+  std::string algodirstr (dashLogDirectory +  adaptationAlgo );
+  const char * algodir = algodirstr.c_str();
+  mkdir (algodir, 0775);
+  std::string dirstr (dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/");
+  const char * dir = dirstr.c_str();
+  mkdir(dir, 0775);
+
+  TcpStreamClientHelper clientHelper (serverAddress, port);
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue (numberOfClients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
+  ApplicationContainer clientApps = clientHelper.Install (clients);
+  for (uint32_t i = 0; i < clientApps.GetN (); i++)
+    {
+      if (i >= packetClients)
+        {
+          clientApps.Get (i)->GetObject<TcpStreamClient> ()->SetFluidNetwork (network, fluidPath);
+        }
+      clientApps.Get (i)->SetStartTime (Seconds (2.0 + i * startInterval));
+    }
+  // the servers keep running, the simulation is done when every client finished its session
+  TcpStreamSessionHelper::StopWhenFinished (clientApps);
+
+  NS_LOG_INFO ("Run Simulation.");
+  Simulator::Run ();
+
+  std::ofstream fluidLog;
+  std::string fluidLogPath = dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/" + "sim" + ToString (simulationId) + "_" + "fluidLog.txt";
+  fluidLog.open (fluidLogPath.c_str ());
+  fluidLog << "Clients Packet_Clients Recomputations Peak_Active_Flows\n";
+  fluidLog << std::setfill (' ') << std::setw (7) << numberOfClients << " "
+           << std::setfill (' ') << std::setw (14) << packetClients << " "
+           << std::setfill (' ') << std::setw (14) << network->GetRecomputations () << " "
+           << std::setfill (' ') << std::setw (17) << network->GetPeakActiveFlows () << "\n";
+  fluidLog.close ();
+
+  Simulator::Destroy ();
+  NS_LOG_INFO ("Done.");
+  return 0;
+}
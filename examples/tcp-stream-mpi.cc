@@ -0,0 +1,317 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Distributed (MPI) simulation of several WiFi cells streaming from one server
+// - The server and the core router run on rank 0, the cells are distributed round robin over the other ranks
+//   (all on rank 0 in a run without MPI)
+// - Every cell is an access point with its own WiFi channel, connected to the core router with a point-to-point link
+// - The session summaries of the clients of all ranks are aggregated on rank 0
+//
+//                   +--- cell 0: AP --- STAs
+//                   |
+//   server --- router --- cell 1: AP --- STAs
+//                   |
+//                   +--- cell n: AP --- STAs
+//
+// Run with e.g. ./waf --run "tcp-stream-mpi --numberOfCells=8 --clientsPerCell=10 ..." --command-template="mpirun -np 4 %s"
+
+#include <fstream>
+#include <iomanip>
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-client.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamMpiExample");
+
+int
+main (int argc, char *argv[])
+{
+//
+// Users may find it convenient to turn on explicit debugging
+// for selected modules; the below lines suggest how to do this
+//
+//   LogComponentEnable ("TcpStreamMpiExample", LOG_LEVEL_INFO);
+
+  uint64_t segmentDuration = 2000000;
+  uint32_t simulationId = 0;
+  uint32_t numberOfCells = 4;
+  uint32_t clientsPerCell = 5;
+  std::string adaptationAlgo = "tobasco";
+  std::string segmentSizeFilePath;
+  std::string coreDataRate = "1000Mb/s";
+  std::string backhaulDataRate = "100Mb/s";
+  std::string backhaulDelay = "10ms";
+  bool nullMessage = false;
+
+  CommandLine cmd;
+  cmd.Usage ("Distributed simulation of several WiFi cells streaming from one server.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfCells", "The number of WiFi cells, distributed round robin over the ranks besides rank 0", numberOfCells);
+  cmd.AddValue ("clientsPerCell", "The number of clients in every cell", clientsPerCell);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithm that the client uses for the simulation", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("coreDataRate", "The data rate of the link between server and core router", coreDataRate);
+  cmd.AddValue ("backhaulDataRate", "The data rate of the link between the core router and every access point", backhaulDataRate);
+  cmd.AddValue ("backhaulDelay", "The delay of the link between the core router and every access point, the lookahead of the ranks", backhaulDelay);
+  cmd.AddValue ("nullMessage", "If true, the ranks synchronize with null messages instead of global barriers", nullMessage);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (numberOfCells == 0 || numberOfCells > 254, "The number of cells has to be between 1 and 254");
+  NS_ABORT_MSG_IF (clientsPerCell > 253, "A cell holds at most 253 clients");
+
+  if (nullMessage)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::NullMessageSimulatorImpl"));
+    }
+  else
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+    }
+  MpiInterface::Enable (&argc, &argv);
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+
+  struct timespec wallClockStart;
+  clock_gettime (CLOCK_MONOTONIC, &wallClockStart);
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  uint32_t numberOfClients = numberOfCells * clientsPerCell;
+
+  /* Core: server and router, on rank 0 */
+  Ptr<Node> serverNode = CreateObject<Node> (0);
+  Ptr<Node> routerNode = CreateObject<Node> (0);
+  NodeContainer allNodes;
+  allNodes.Add (serverNode);
+  allNodes.Add (routerNode);
+
+  PointToPointHelper coreLink;
+  coreLink.SetDeviceAttribute ("DataRate", StringValue (coreDataRate));
+  coreLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+  coreLink.SetChannelAttribute ("Delay", StringValue ("35ms"));
+  NetDeviceContainer coreDevices = coreLink.Install (serverNode, routerNode);
+
+  /* The links between router and access points cross ranks, their delay is the lookahead of the simulation */
+  PointToPointHelper backhaulLink;
+  backhaulLink.SetDeviceAttribute ("DataRate", StringValue (backhaulDataRate));
+  backhaulLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+  backhaulLink.SetChannelAttribute ("Delay", StringValue (backhaulDelay));
+
+  WifiHelper wifiHelper;
+  wifiHelper.SetStandard (WIFI_PHY_STANDARD_80211n_5GHZ);
+  wifiHelper.SetRemoteStationManager ("ns3::MinstrelHtWifiManager");
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+
+  std::vector<NetDeviceContainer> backhaulDevices;
+  std::vector<NetDeviceContainer> wlanDevices;
+  std::vector <std::pair <Ptr<Node>, std::string> > clients;
+  for (uint32_t c = 0; c < numberOfCells; c++)
+    {
+      /* Every node of a cell lives on the rank of the cell, rank 0 only runs the core if there are other ranks */
+      uint32_t rank = systemCount > 1 ? 1 + c % (systemCount - 1) : 0;
+      Ptr<Node> apNode = CreateObject<Node> (rank);
+      NodeContainer staNodes;
+      staNodes.Create (clientsPerCell, rank);
+      allNodes.Add (apNode);
+      allNodes.Add (staNodes);
+      for (uint32_t i = 0; i < staNodes.GetN (); i++)
+        {
+          clients.push_back (std::make_pair (staNodes.Get (i), adaptationAlgo));
+        }
+
+      backhaulDevices.push_back (backhaulLink.Install (routerNode, apNode));
+
+      /* Every cell has a channel of its own, cells do not interfere with each other */
+      YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+      YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+      wifiPhy.Set ("TxPowerStart", DoubleValue (20.0));
+      wifiPhy.Set ("TxPowerEnd", DoubleValue (20.0));
+      wifiPhy.Set ("TxPowerLevels", UintegerValue (1));
+      wifiPhy.SetErrorRateModel ("ns3::YansErrorRateModel");
+      wifiPhy.SetChannel (wifiChannel.Create ());
+      wifiPhy.Set ("ShortGuardEnabled", BooleanValue (true));
+      wifiPhy.Set ("Antennas", UintegerValue (4));
+
+      WifiMacHelper wifiMac;
+      Ssid ssid = Ssid ("cell" + ToString (c));
+      wifiMac.SetType ("ns3::StaWifiMac", "Ssid", SsidValue (ssid));
+      NetDeviceContainer cellDevices = wifiHelper.Install (wifiPhy, wifiMac, staNodes);
+      wifiMac.SetType ("ns3::ApWifiMac", "Ssid", SsidValue (ssid));
+      cellDevices.Add (wifiHelper.Install (wifiPhy, wifiMac, apNode));
+      wlanDevices.push_back (cellDevices);
+
+      /* The clients are placed randomly within 15 meters of their access point */
+      Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+      Ptr<UniformDiscPositionAllocator> discAlloc = CreateObject<UniformDiscPositionAllocator> ();
+      discAlloc->SetRho (15.0);
+      discAlloc->AssignStreams (simulationId * numberOfCells + c);
+      for (uint32_t i = 0; i < staNodes.GetN (); i++)
+        {
+          positionAlloc->Add (discAlloc->GetNext ());
+        }
+      positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+      mobility.SetPositionAllocator (positionAlloc);
+      mobility.Install (staNodes);
+      mobility.Install (apNode);
+    }
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/ChannelWidth", UintegerValue (40));
+
+  /* Internet stack, every rank builds the whole topology */
+  InternetStackHelper stack;
+  stack.Install (allNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("76.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer coreInterface = address.Assign (coreDevices);
+  Address serverAddress = Address (coreInterface.GetAddress (0));
+  address.SetBase ("172.16.0.0", "255.255.255.252");
+  for (uint32_t c = 0; c < numberOfCells; c++)
+    {
+      address.Assign (backhaulDevices.at (c));
+      address.NewNetwork ();
+    }
+  for (uint32_t c = 0; c < numberOfCells; c++)
+    {
+      address.SetBase (Ipv4Address (("10." + ToString (c + 1) + ".0.0").c_str ()), "255.255.255.0");
+      address.Assign (wlanDevices.at (c));
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  uint16_t port = 9;
+
+  /* Every rank may create the log directories, mkdir leaves existing ones alone */
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, 0775);
+  std::string algodirstr (dashLogDirectory +  adaptationAlgo );
+  const char * algodir = algodirstr.c_str();
+  mkdir (algodir, 0775);
+  std::string dirstr (dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/");
+  const char * dir = dirstr.c_str();
+  mkdir(dir, 0775);
+
+  /* The server only runs on the rank of its node */
+  if (serverNode->GetSystemId () == systemId)
+    {
+      TcpStreamServerHelper serverHelper (port);
+      serverHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+      ApplicationContainer serverApp = serverHelper.Install (serverNode);
+      serverApp.Start (Seconds (1.0));
+    }
+
+  /* The helper installs the clients of the local rank only, with the ids of their index in clients */
+  TcpStreamClientHelper clientHelper (serverAddress, port);
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue (numberOfClients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
+  ApplicationContainer clientApps = clientHelper.Install (clients);
+  for (uint32_t i = 0; i < clientApps.GetN (); i++)
+    {
+      UintegerValue clientId;
+      clientApps.Get (i)->GetAttribute ("ClientId", clientId);
+      clientApps.Get (i)->SetStartTime (Seconds (2.0 + (clientId.Get () * 3) / 100.0));
+    }
+  // every rank with clients runs until its own clients finished their sessions. The core rank never stops on
+  // its own, the clients of the other ranks still need the server: it is done once its events ran out and
+  // all other ranks stopped
+  if (serverNode->GetSystemId () != systemId || systemCount == 1)
+    {
+      TcpStreamSessionHelper::StopWhenFinished (clientApps);
+    }
+
+  NS_LOG_INFO ("Run Simulation on rank " << systemId << " of " << systemCount);
+  Simulator::Run ();
+
+  /* Sum up the sessions of the local clients, then of all ranks on rank 0 */
+  double totals[6] = { 0, 0, 0, 0, 0, 0 };
+  for (uint32_t i = 0; i < clientApps.GetN (); i++)
+    {
+      sessionData session = clientApps.Get (i)->GetObject<TcpStreamClient> ()->GetSessionData ();
+      totals[0] += 1;
+      if (session.startupDelay >= 0)
+        {
+          totals[1] += 1;
+          totals[2] += session.startupDelay;
+        }
+      totals[3] += session.averageThroughput;
+      totals[4] += session.segments;
+      totals[5] += session.scheduledEvents;
+    }
+  struct timespec wallClockEnd;
+  clock_gettime (CLOCK_MONOTONIC, &wallClockEnd);
+  double wallClock = (wallClockEnd.tv_sec - wallClockStart.tv_sec) + (wallClockEnd.tv_nsec - wallClockStart.tv_nsec) / 1e9;
+  double globalTotals[6];
+  double maxWallClock;
+#ifdef NS3_MPI
+  MPI_Reduce (totals, globalTotals, 6, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (&wallClock, &maxWallClock, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+#else
+  std::copy (totals, totals + 6, globalTotals);
+  maxWallClock = wallClock;
+#endif
+
+  if (systemId == 0)
+    {
+      std::ofstream summaryLog;
+      std::string summaryLogPath = dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/" + "sim" + ToString (simulationId) + "_" + "mpiSummaryLog.txt";
+      summaryLog.open (summaryLogPath.c_str ());
+      summaryLog << "Ranks Cells Clients Average_Startup_Delay Average_Throughput Segments Scheduled_Events Wall_Clock\n";
+      summaryLog << std::setfill (' ') << std::setw (5) << systemCount << " "
+                 << std::setfill (' ') << std::setw (5) << numberOfCells << " "
+                 << std::setfill (' ') << std::setw (7) << globalTotals[0] << " "
+                 << std::setfill (' ') << std::setw (21) << (globalTotals[1] > 0 ? globalTotals[2] / globalTotals[1] : -1) << " "
+                 << std::setfill (' ') << std::setw (18) << (globalTotals[0] > 0 ? globalTotals[3] / globalTotals[0] : 0) << " "
+                 << std::setfill (' ') << std::setw (8) << globalTotals[4] << " "
+                 << std::setfill (' ') << std::setw (16) << globalTotals[5] << " "
+                 << std::setfill (' ') << std::setw (10) << maxWallClock << "\n";
+      summaryLog.close ();
+    }
+
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  NS_LOG_INFO ("Done.");
+  return 0;
+}
@@ -0,0 +1,253 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - TCP Stream server and user-defined number of clients behind point-to-point links
+// - The data rate of the links follows recorded bandwidth traces, either of every access link or of the shared bottleneck
+// - Tracing of throughput, packet information is done in the client
+//
+//   server ---- edge router ==== access router ---- clients
+//
+//   ==== bottleneck
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/bandwidth-trace.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamTraceExample");
+
+static std::ofstream g_rateLog; //!< Output stream for logging the data rate of the bottleneck
+
+static void
+LogRate (DataRate rate)
+{
+  g_rateLog << std::setfill (' ') << std::setw (13) << Simulator::Now ().GetMicroSeconds () / (double) 1000000 << " "
+            << std::setfill (' ') << std::setw (13) << rate.GetBitRate () / 1000000.0 << "\n";
+}
+
+int
+main (int argc, char *argv[])
+{
+//
+// Users may find it convenient to turn on explicit debugging
+// for selected modules; the below lines suggest how to do this
+//
+//   LogComponentEnable ("TcpStreamTraceExample", LOG_LEVEL_INFO);
+//   LogComponentEnable ("BandwidthTrace", LOG_LEVEL_INFO);
+
+  uint64_t segmentDuration = 2000000;
+  uint32_t simulationId = 0;
+  uint32_t numberOfClients = 10;
+  std::string adaptationAlgo = "tobasco";
+  std::string segmentSizeFilePath;
+  std::string traces;
+  std::string replay = "access";
+  std::string bottleneckRate = "1Gb/s";
+  std::string bottleneckDelay = "40ms";
+  std::string accessRate = "20Mb/s";
+  bool randomOffset = true;
+  double startInterval = 0.03;
+
+  CommandLine cmd;
+  cmd.Usage ("Simulation of streaming with DASH over links replaying bandwidth traces.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfClients", "The number of clients", numberOfClients);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithm that the client uses for the simulation", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("traces", "Comma separated bandwidth traces, one \"time throughput\" pair per line in seconds and Mbps", traces);
+  cmd.AddValue ("replay", "Where the traces are replayed: access for the access link of every client, client i replaying trace i modulo the number of traces, or bottleneck for the shared bottleneck replaying the first trace", replay);
+  cmd.AddValue ("bottleneckRate", "The data rate of the bottleneck link, only used with replay access", bottleneckRate);
+  cmd.AddValue ("bottleneckDelay", "The delay of the bottleneck link", bottleneckDelay);
+  cmd.AddValue ("accessRate", "The data rate of the access link of every client, only used with replay bottleneck", accessRate);
+  cmd.AddValue ("randomOffset", "If true, every link starts replaying its trace at a random point, so links replaying the same trace differ", randomOffset);
+  cmd.AddValue ("startInterval", "The time in seconds between the starts of two consecutive clients", startInterval);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (replay != "access" && replay != "bottleneck", "The traces have to be replayed on the access links or the bottleneck");
+
+  std::vector<std::string> traceFiles;
+  std::stringstream traceStream (traces);
+  std::string trace;
+  while (std::getline (traceStream, trace, ','))
+    {
+      traceFiles.push_back (trace);
+    }
+  NS_ABORT_MSG_IF (traceFiles.empty (), "At least one bandwidth trace is needed");
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  /* Create Nodes */
+  Ptr<Node> serverNode = CreateObject<Node> ();
+  Ptr<Node> edgeRouter = CreateObject<Node> ();
+  Ptr<Node> accessRouter = CreateObject<Node> ();
+  NodeContainer clientNodes;
+  clientNodes.Create (numberOfClients);
+
+  std::vector <std::pair <Ptr<Node>, std::string> > clients;
+  for (uint32_t i = 0; i < clientNodes.GetN (); i++)
+    {
+      clients.push_back (std::make_pair (clientNodes.Get (i), adaptationAlgo));
+    }
+
+  /* Set up WAN link between server node and edge router, it is never the bottleneck */
+  PointToPointHelper wanLink;
+  wanLink.SetDeviceAttribute ("DataRate", StringValue ("10Gb/s"));
+  wanLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+  wanLink.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  NetDeviceContainer wanDevices = wanLink.Install (serverNode, edgeRouter);
+
+  PointToPointHelper bottleneckLink;
+  bottleneckLink.SetDeviceAttribute ("DataRate", StringValue (bottleneckRate));
+  bottleneckLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+  bottleneckLink.SetChannelAttribute ("Delay", StringValue (bottleneckDelay));
+  NetDeviceContainer bottleneckDevices = bottleneckLink.Install (edgeRouter, accessRouter);
+
+  PointToPointHelper accessLink;
+  accessLink.SetDeviceAttribute ("DataRate", StringValue (accessRate));
+  accessLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+  accessLink.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  std::vector<NetDeviceContainer> accessDevices;
+  for (uint32_t i = 0; i < clientNodes.GetN (); i++)
+    {
+      accessDevices.push_back (accessLink.Install (accessRouter, clientNodes.Get (i)));
+    }
+
+  /* Replay the traces in the direction towards the clients, every trace file is read once */
+  Ptr<UniformRandomVariable> offset = CreateObject<UniformRandomVariable> ();
+  offset->SetStream (simulationId);
+  std::vector<Ptr<BandwidthTraceReplay> > replays;
+  std::vector<Ptr<NetDevice> > replayDevices;
+  if (replay == "access")
+    {
+      for (uint32_t i = 0; i < accessDevices.size (); i++)
+        {
+          replayDevices.push_back (accessDevices.at (i).Get (0));
+        }
+    }
+  else
+    {
+      replayDevices.push_back (bottleneckDevices.Get (0));
+    }
+  for (uint32_t i = 0; i < replayDevices.size (); i++)
+    {
+      std::string traceFile = traceFiles.at (i % traceFiles.size ());
+      Ptr<const BandwidthTrace> bandwidthTrace = BandwidthTrace::Load (traceFile);
+      NS_ABORT_MSG_IF (bandwidthTrace == 0, "Couldn't read the bandwidth trace " << traceFile);
+      Ptr<BandwidthTraceReplay> traceReplay = CreateObject<BandwidthTraceReplay> ();
+      traceReplay->SetAttribute ("TraceFilePath", StringValue (traceFile));
+      if (randomOffset)
+        {
+          traceReplay->SetAttribute ("Offset", TimeValue (Seconds (offset->GetValue (0, bandwidthTrace->GetPeriod ().GetSeconds ()))));
+        }
+      traceReplay->Install (replayDevices.at (i));
+      replays.push_back (traceReplay);
+    }
+
+  /* Internet stack */
+  InternetStackHelper stack;
+  stack.Install (serverNode);
+  stack.Install (edgeRouter);
+  stack.Install (accessRouter);
+  stack.Install (clientNodes);
+
+  /* Assign IP addresses */
+  Ipv4AddressHelper address;
+  address.SetBase ("76.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer wanInterface = address.Assign (wanDevices);
+  Address serverAddress = Address (wanInterface.GetAddress (0));
+  address.SetBase ("76.1.2.0", "255.255.255.0");
+  address.Assign (bottleneckDevices);
+  /* One /30 network per access link */
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < accessDevices.size (); i++)
+    {
+      address.Assign (accessDevices.at (i));
+      address.NewNetwork ();
+    }
+
+  /* Populate routing table */
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  uint16_t port = 9;
+
+  // create folder for the logs of the clients
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, 0775);
+  std::string algodirstr (dashLogDirectory +  adaptationAlgo );
+  const char * algodir = algodirstr.c_str();
+  mkdir (algodir, 0775);
+  std::string dirstr (dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/");
+  const char * dir = dirstr.c_str();
+  mkdir(dir, 0775);
+
+  if (replay == "bottleneck")
+    {
+      std::string rateLogPath = dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/" + "sim" + ToString (simulationId) + "_" + "bottleneckRateLog.txt";
+      g_rateLog.open (rateLogPath.c_str ());
+      g_rateLog << "     Time_Now     Rate_Mbps\n";
+      replays.at (0)->TraceConnectWithoutContext ("RateChanged", MakeCallback (&LogRate));
+    }
+
+  /* Install TCP Receiver on the server */
+  TcpStreamServerHelper serverHelper (port);
+  serverHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  ApplicationContainer serverApp = serverHelper.Install (serverNode);
+  serverApp.Start (Seconds (1.0));
+
+  /* Install TCP/UDP Transmitter on the clients */
+  TcpStreamClientHelper clientHelper (serverAddress, port);
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue (numberOfClients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
+  ApplicationContainer clientApps = clientHelper.Install (clients);
+  for (uint32_t i = 0; i < clientApps.GetN (); i++)
+    {
+      clientApps.Get (i)->SetStartTime (Seconds (2.0 + i * startInterval));
+    }
+  // the server keeps running, the simulation is done when every client finished its session
+  TcpStreamSessionHelper::StopWhenFinished (clientApps);
+
+  NS_LOG_INFO ("Run Simulation.");
+  Simulator::Run ();
+  g_rateLog.close ();
+  Simulator::Destroy ();
+  NS_LOG_INFO ("Done.");
+  return 0;
+}
@@ -0,0 +1,355 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - TCP Stream server and user-defined number of clients behind a wired bottleneck
+// - Dumbbell or tree of point-to-point links, selectable queue discipline at the bottleneck
+// - Tracing of throughput, packet information is done in the client
+// - Optionally, clients arrive according to an arrival process and leave after a random session length
+//
+//   dumbbell:  server ---- edge router ==== access router ---- clients
+//   tree:      server ---- edge router ==== access router ---- aggregation routers ---- clients
+//
+//   ==== bottleneck, its queue disc is installed at the edge router, towards the clients
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamWiredExample");
+
+int
+main (int argc, char *argv[])
+{
+//
+// Users may find it convenient to turn on explicit debugging
+// for selected modules; the below lines suggest how to do this
+//
+//   LogComponentEnable ("TcpStreamWiredExample", LOG_LEVEL_INFO);
+//   LogComponentEnable ("TcpStreamClientApplication", LOG_LEVEL_INFO);
+//   LogComponentEnable ("TcpStreamServerApplication", LOG_LEVEL_INFO);
+
+  uint64_t segmentDuration = 2000000;
+  uint32_t simulationId = 0;
+  uint32_t numberOfClients = 100;
+  std::string adaptationAlgo = "tobasco";
+  std::string segmentSizeFilePath;
+  std::string topology = "dumbbell";
+  std::string bottleneckRate = "100Mb/s";
+  std::string bottleneckDelay = "40ms";
+  std::string queueDisc = "fifo";
+  std::string queueSize = "1000p";
+  std::string accessRate = "20Mb/s";
+  std::string accessDelay = "2ms";
+  uint32_t fanout = 16;
+  std::string aggregationRate = "1Gb/s";
+  double startInterval = 0.03;
+  std::string arrivalProcess = "none";
+  double arrivalRate = 1.0;
+  double diurnalAmplitude = 0.5;
+  double diurnalPeriod = 86400.0;
+  std::string arrivalTrace;
+  std::string sessionLength;
+  double endTime = 0;
+
+  CommandLine cmd;
+  cmd.Usage ("Simulation of streaming with DASH over a wired bottleneck.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfClients", "The number of clients", numberOfClients);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithm that the client uses for the simulation", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("topology", "The network behind the bottleneck: dumbbell, or tree for aggregation routers between access router and clients", topology);
+  cmd.AddValue ("bottleneckRate", "The data rate of the bottleneck link", bottleneckRate);
+  cmd.AddValue ("bottleneckDelay", "The delay of the bottleneck link", bottleneckDelay);
+  cmd.AddValue ("queueDisc", "The queue discipline at the bottleneck: fifo, codel, fqcodel or pie", queueDisc);
+  cmd.AddValue ("queueSize", "The maximum size of the bottleneck queue, in packets (p) or bytes (B)", queueSize);
+  cmd.AddValue ("accessRate", "The data rate of the access link of every client", accessRate);
+  cmd.AddValue ("accessDelay", "The delay of the access link of every client", accessDelay);
+  cmd.AddValue ("fanout", "The number of clients per aggregation router, only used with topology tree", fanout);
+  cmd.AddValue ("aggregationRate", "The data rate of the links between access and aggregation routers, only used with topology tree", aggregationRate);
+  cmd.AddValue ("startInterval", "The time in seconds between the starts of two consecutive clients without arrival process", startInterval);
+  cmd.AddValue ("arrivalProcess", "The arrival process of the clients: none (one every startInterval), poisson, diurnal or trace", arrivalProcess);
+  cmd.AddValue ("arrivalRate", "The mean number of arriving clients per second, for the poisson and diurnal arrival processes", arrivalRate);
+  cmd.AddValue ("diurnalAmplitude", "The relative deviation of the diurnal arrival rate from its mean at peak time", diurnalAmplitude);
+  cmd.AddValue ("diurnalPeriod", "The length of a day in seconds, for the diurnal arrival process", diurnalPeriod);
+  cmd.AddValue ("arrivalTrace", "The file with the arrival time in seconds of every client, one per line, for the trace arrival process", arrivalTrace);
+  cmd.AddValue ("sessionLength", "The distribution of the time in seconds a client watches, e.g. ns3::ExponentialRandomVariable[Mean=600], the whole video if empty", sessionLength);
+  cmd.AddValue ("endTime", "The end of the simulation in seconds, 0 to end once every client finished its session", endTime);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (topology != "dumbbell" && topology != "tree", "The topology has to be dumbbell or tree");
+  NS_ABORT_MSG_IF (topology == "tree" && fanout == 0, "The fanout of the tree has to be at least 1");
+  NS_ABORT_MSG_IF (arrivalProcess != "none" && arrivalProcess != "poisson" && arrivalProcess != "diurnal" && arrivalProcess != "trace",
+                   "The arrival process has to be none, poisson, diurnal or trace");
+  NS_ABORT_MSG_IF (endTime == 0 && arrivalProcess != "none", "Clients arriving according to an arrival process need an endTime");
+
+  std::string queueDiscType;
+  if (queueDisc == "fifo")
+    {
+      queueDiscType = "ns3::FifoQueueDisc";
+    }
+  else if (queueDisc == "codel")
+    {
+      queueDiscType = "ns3::CoDelQueueDisc";
+    }
+  else if (queueDisc == "fqcodel")
+    {
+      queueDiscType = "ns3::FqCoDelQueueDisc";
+    }
+  else if (queueDisc == "pie")
+    {
+      queueDiscType = "ns3::PieQueueDisc";
+    }
+  else
+    {
+      NS_ABORT_MSG ("The queue discipline has to be fifo, codel, fqcodel or pie");
+    }
+
+  struct timespec wallClockStart;
+  clock_gettime (CLOCK_MONOTONIC, &wallClockStart);
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  /* Create Nodes */
+  Ptr<Node> serverNode = CreateObject<Node> ();
+  Ptr<Node> edgeRouter = CreateObject<Node> ();
+  Ptr<Node> accessRouter = CreateObject<Node> ();
+  NodeContainer clientNodes;
+  clientNodes.Create (numberOfClients);
+  NodeContainer aggregationRouters;
+  if (topology == "tree")
+    {
+      aggregationRouters.Create ((numberOfClients + fanout - 1) / fanout);
+    }
+
+  std::vector <std::pair <Ptr<Node>, std::string> > clients;
+  for (uint32_t i = 0; i < clientNodes.GetN (); i++)
+    {
+      clients.push_back (std::make_pair (clientNodes.Get (i), adaptationAlgo));
+    }
+
+  /* Set up WAN link between server node and edge router, it is never the bottleneck */
+  PointToPointHelper wanLink;
+  wanLink.SetDeviceAttribute ("DataRate", StringValue ("10Gb/s"));
+  wanLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+  wanLink.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  NetDeviceContainer wanDevices = wanLink.Install (serverNode, edgeRouter);
+
+  /* Bottleneck, with a device queue of a single packet so the queue disc holds the backlog */
+  PointToPointHelper bottleneckLink;
+  bottleneckLink.SetDeviceAttribute ("DataRate", StringValue (bottleneckRate));
+  bottleneckLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+  bottleneckLink.SetChannelAttribute ("Delay", StringValue (bottleneckDelay));
+  bottleneckLink.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+  NetDeviceContainer bottleneckDevices = bottleneckLink.Install (edgeRouter, accessRouter);
+
+  PointToPointHelper accessLink;
+  accessLink.SetDeviceAttribute ("DataRate", StringValue (accessRate));
+  accessLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+  accessLink.SetChannelAttribute ("Delay", StringValue (accessDelay));
+
+  std::vector<NetDeviceContainer> aggregationDevices;
+  std::vector<NetDeviceContainer> accessDevices;
+  if (topology == "tree")
+    {
+      PointToPointHelper aggregationLink;
+      aggregationLink.SetDeviceAttribute ("DataRate", StringValue (aggregationRate));
+      aggregationLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+      aggregationLink.SetChannelAttribute ("Delay", StringValue ("1ms"));
+      for (uint32_t i = 0; i < aggregationRouters.GetN (); i++)
+        {
+          aggregationDevices.push_back (aggregationLink.Install (accessRouter, aggregationRouters.Get (i)));
+        }
+      for (uint32_t i = 0; i < clientNodes.GetN (); i++)
+        {
+          accessDevices.push_back (accessLink.Install (aggregationRouters.Get (i / fanout), clientNodes.Get (i)));
+        }
+    }
+  else
+    {
+      for (uint32_t i = 0; i < clientNodes.GetN (); i++)
+        {
+          accessDevices.push_back (accessLink.Install (accessRouter, clientNodes.Get (i)));
+        }
+    }
+
+  /* Internet stack */
+  InternetStackHelper stack;
+  stack.Install (serverNode);
+  stack.Install (edgeRouter);
+  stack.Install (accessRouter);
+  stack.Install (aggregationRouters);
+  stack.Install (clientNodes);
+
+  /* Queue disc at the bottleneck, installed before the addresses so it replaces the default one */
+  TrafficControlHelper trafficControl;
+  trafficControl.SetRootQueueDisc (queueDiscType, "MaxSize", StringValue (queueSize));
+  QueueDiscContainer bottleneckQueueDiscs = trafficControl.Install (bottleneckDevices.Get (0));
+
+  /* Assign IP addresses */
+  Ipv4AddressHelper address;
+  address.SetBase ("76.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer wanInterface = address.Assign (wanDevices);
+  Address serverAddress = Address (wanInterface.GetAddress (0));
+  address.SetBase ("76.1.2.0", "255.255.255.0");
+  address.Assign (bottleneckDevices);
+  /* One /30 network per link */
+  address.SetBase ("172.16.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < aggregationDevices.size (); i++)
+    {
+      address.Assign (aggregationDevices.at (i));
+      address.NewNetwork ();
+    }
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < accessDevices.size (); i++)
+    {
+      address.Assign (accessDevices.at (i));
+      address.NewNetwork ();
+    }
+
+  /* Populate routing table */
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  uint16_t port = 9;
+
+  // create folder for the logs of the clients
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, 0775);
+  std::string algodirstr (dashLogDirectory +  adaptationAlgo );
+  const char * algodir = algodirstr.c_str();
+  mkdir (algodir, 0775);
+  std::string dirstr (dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/");
+  const char * dir = dirstr.c_str();
+  mkdir(dir, 0775);
+
+  /* Install TCP Receiver on the server */
+  TcpStreamServerHelper serverHelper (port);
+  serverHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  ApplicationContainer serverApp = serverHelper.Install (serverNode);
+  serverApp.Start (Seconds (1.0));
+
+  /* Install TCP/UDP Transmitter on the clients */
+  TcpStreamClientHelper clientHelper (serverAddress, port);
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue (numberOfClients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
+  ApplicationContainer clientApps = clientHelper.Install (clients);
+
+  /* Arrivals and departures of the clients */
+  TcpStreamSessionHelper sessionHelper;
+  if (arrivalProcess == "poisson")
+    {
+      sessionHelper.SetPoissonArrivals (arrivalRate);
+    }
+  else if (arrivalProcess == "diurnal")
+    {
+      sessionHelper.SetDiurnalArrivals (arrivalRate, diurnalAmplitude, Seconds (diurnalPeriod));
+    }
+  else if (arrivalProcess == "trace")
+    {
+      sessionHelper.SetTraceArrivals (arrivalTrace);
+    }
+  if (!sessionLength.empty ())
+    {
+      ObjectFactory lengthFactory;
+      std::istringstream lengthStream (sessionLength);
+      lengthStream >> lengthFactory;
+      sessionHelper.SetSessionLength (lengthFactory.Create<RandomVariableStream> ());
+    }
+  sessionHelper.AssignStreams (simulationId * 3);
+  sessionHelper.Schedule (clientApps, Seconds (2.0), Seconds (startInterval), endTime > 0 ? Seconds (endTime) : Time::Max ());
+  if (endTime > 0)
+    {
+      // clients still watching at the end are stopped, so their sessions are logged as well
+      for (uint32_t i = 0; i < clientApps.GetN (); i++)
+        {
+          TimeValue start, stop;
+          clientApps.Get (i)->GetAttribute ("StartTime", start);
+          clientApps.Get (i)->GetAttribute ("StopTime", stop);
+          if (start.Get () < Seconds (endTime) && (stop.Get ().IsZero () || stop.Get () > Seconds (endTime)))
+            {
+              clientApps.Get (i)->SetStopTime (Seconds (endTime));
+            }
+        }
+      // the server keeps serving arriving clients until the end, no matter how many are connected
+      serverApp.Stop (Seconds (endTime));
+      // the stop events of the applications are scheduled once the simulation runs, after this one, so the
+      // simulation ends just after them
+      Simulator::Stop (Seconds (endTime) + NanoSeconds (1));
+    }
+  else
+    {
+      TcpStreamSessionHelper::StopWhenFinished (clientApps);
+    }
+
+  NS_LOG_INFO ("Run Simulation.");
+  NS_LOG_INFO ("Sim: " << simulationId << "Clients: " << numberOfClients);
+  Simulator::Run ();
+
+  // drops and marks of the bottleneck queue, to compare the queue disciplines
+  std::ofstream queueLog;
+  std::string queueLogPath = dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/" + "sim" + ToString (simulationId) + "_" + "queueLog.txt";
+  queueLog.open (queueLogPath.c_str ());
+  queueLog << "Queue_Disc " << queueDisc << "\n";
+  queueLog << bottleneckQueueDiscs.Get (0)->GetStats () << "\n";
+  queueLog.close ();
+
+  // cost of the simulation, to size the machines running it
+  struct timespec wallClockEnd;
+  clock_gettime (CLOCK_MONOTONIC, &wallClockEnd);
+  double wallClock = (wallClockEnd.tv_sec - wallClockStart.tv_sec) + (wallClockEnd.tv_nsec - wallClockStart.tv_nsec) / 1e9;
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  std::ofstream runtimeLog;
+  std::string runtimeLogPath = dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/" + "sim" + ToString (simulationId) + "_" + "runtimeLog.txt";
+  runtimeLog.open (runtimeLogPath.c_str ());
+  runtimeLog << "Topology Wall_Clock Simulated_Time Simulated_Seconds_Per_Second Peak_RSS_kB\n";
+  runtimeLog << std::setfill (' ') << std::setw (8) << topology << " "
+             << std::setfill (' ') << std::setw (10) << wallClock << " "
+             << std::setfill (' ') << std::setw (14) << Simulator::Now ().GetSeconds () << " "
+             << std::setfill (' ') << std::setw (28) << Simulator::Now ().GetSeconds () / wallClock << " "
+             << std::setfill (' ') << std::setw (11) << usage.ru_maxrss << "\n";
+  runtimeLog.close ();
+  Simulator::Destroy ();
+  NS_LOG_INFO ("Done.");
+  return 0;
+}
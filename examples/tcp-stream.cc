@@ -22,6 +22,7 @@
 
 #include "ns3/point-to-point-helper.h"
 #include <fstream>
+#include <iomanip>
 #include "ns3/core-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/internet-module.h"
@@ -34,9 +35,13 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <errno.h>
+#include <time.h>
+#include <sys/resource.h>
 #include "ns3/flow-monitor-module.h"
 #include "ns3/tcp-stream-helper.h"
 #include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-cache-proxy.h"
+#include "ns3/video-catalog.h"
 
 template <typename T>
 std::string ToString(T val)
@@ -69,6 +74,28 @@ main (int argc, char *argv[])
   uint32_t numberOfClients;
   std::string adaptationAlgo;
   std::string segmentSizeFilePath;
+  std::string segmentQualityFilePath = "";
+  bool serverHints = false;
+  bool cacheProxy = false;
+  uint64_t cacheCapacity = 100000000;
+  uint32_t numberOfServers = 1;
+  std::string loadBalancing = "RoundRobin";
+  std::string serverWeights = "";
+  bool serverSwitching = false;
+  bool live = false;
+  double liveStartTime = 0.0;
+  double targetLatency = 6.0;
+  uint32_t chunks = 1;
+  bool push = false;
+  uint32_t batchSize = 1;
+  double batchThreshold = 10.0;
+  std::string neuralWeights = "";
+  std::string topology = "wifi";
+  std::string accessDataRate = "20Mb/s";
+  std::string catalogFilePath = "";
+  std::string titleAssignment = "";
+  double zipfExponent = 0.8;
+  uint32_t clientsPerNode = 1;
 
   bool shortGuardInterval = true;
 
@@ -79,12 +106,47 @@ main (int argc, char *argv[])
   cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
   cmd.AddValue ("adaptationAlgo", "The adaptation algorithm that the client uses for the simulation", adaptationAlgo);
   cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("segmentQualityFile", "The relative path (from ns-3.x directory) to the file containing the perceptual quality of every segment, in the layout of the segment size file", segmentQualityFilePath);
+  cmd.AddValue ("serverHints", "If true, the server piggybacks bandwidth hints on its responses", serverHints);
+  cmd.AddValue ("cacheProxy", "If true, the clients are served by an edge cache installed on the access point", cacheProxy);
+  cmd.AddValue ("cacheCapacity", "The capacity of the edge cache in bytes", cacheCapacity);
+  cmd.AddValue ("numberOfServers", "The number of servers the clients are distributed over", numberOfServers);
+  cmd.AddValue ("loadBalancing", "The policy clients are assigned to servers with: RoundRobin, ConsistentHashing, LeastConnections or Weighted", loadBalancing);
+  cmd.AddValue ("serverWeights", "Comma separated capacity weights of the servers, for the Weighted policy", serverWeights);
+  cmd.AddValue ("serverSwitching", "If true, every client may switch between all servers based on the throughput it measured from them, instead of being assigned to one server", serverSwitching);
+  cmd.AddValue ("live", "If true, the video is streamed live and the clients start at the live edge", live);
+  cmd.AddValue ("liveStartTime", "The point in time in seconds the live stream started", liveStartTime);
+  cmd.AddValue ("targetLatency", "The latency to the live edge in seconds the clients aim at by adjusting their playback rate", targetLatency);
+  cmd.AddValue ("chunks", "The number of chunks every segment is split into for chunked delivery, 1 disables chunking", chunks);
+  cmd.AddValue ("push", "If true, the clients subscribe once and the server pushes the segments on the connection, instead of the clients requesting every segment", push);
+  cmd.AddValue ("batchSize", "The maximum number of consecutive segments a client requests at once while its buffer is above batchThreshold, 1 disables batching", batchSize);
+  cmd.AddValue ("batchThreshold", "The buffer level in seconds from which on the clients request segments in batches", batchThreshold);
+  cmd.AddValue ("neuralWeights", "The relative path (from ns-3.x directory) to the weights file of the neural adaptation algorithm", neuralWeights);
+  cmd.AddValue ("topology", "The access network of the clients: wifi, or p2p for one point-to-point link per client to the access point", topology);
+  cmd.AddValue ("accessDataRate", "The data rate of the access link of every client, only used with topology p2p", accessDataRate);
+  cmd.AddValue ("catalog", "The relative path (from ns-3.x directory) to a catalog of videos, one segment size file and optionally segment quality file per line by decreasing popularity. If set, every client streams a title of the catalog instead of segmentSizeFile", catalogFilePath);
+  cmd.AddValue ("titleAssignment", "The relative path (from ns-3.x directory) to a file with the title index of every client, one per line. If empty, the titles are drawn by popularity", titleAssignment);
+  cmd.AddValue ("clientsPerNode", "The number of clients sharing one station, e.g. the screens of a household; numberOfClients has to be a multiple of it", clientsPerNode);
+  cmd.AddValue ("zipfExponent", "The exponent of the Zipf distribution of the popularity of the titles of the catalog", zipfExponent);
   cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (numberOfServers == 0, "At least one server is needed");
+  NS_ABORT_MSG_IF (numberOfServers > 1 && cacheProxy, "The edge cache fetches from a single server, it can not be combined with several servers");
+  NS_ABORT_MSG_IF (push && cacheProxy, "The edge cache serves requested segments, it can not be combined with pushed segments");
+  NS_ABORT_MSG_IF (batchSize > 1 && cacheProxy, "The edge cache serves single segments, it can not be combined with batched requests");
+  NS_ABORT_MSG_IF (batchSize > 1 && push, "Pushed segments are not requested, push can not be combined with batched requests");
+  NS_ABORT_MSG_IF (!catalogFilePath.empty () && push, "The server pushes the segments of a single video, push can not be combined with a catalog");
+  NS_ABORT_MSG_IF (topology != "wifi" && topology != "p2p", "The topology has to be wifi or p2p");
+  NS_ABORT_MSG_IF (clientsPerNode == 0 || numberOfClients % clientsPerNode != 0, "The number of clients has to be a multiple of the clients per station");
+  uint32_t numberOfStations = numberOfClients / clientsPerNode;
+
+  struct timespec wallClockStart;
+  clock_gettime (CLOCK_MONOTONIC, &wallClockStart);
 
 
   Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
   Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
   Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+  Config::SetDefault ("ns3::NeuralAlgorithm::WeightsFile", StringValue (neuralWeights));
 
   WifiHelper wifiHelper;
   wifiHelper.SetStandard (WIFI_PHY_STANDARD_80211n_5GHZ);
@@ -111,7 +173,7 @@ main (int argc, char *argv[])
 
   /* Create Nodes */
   NodeContainer networkNodes;
-  networkNodes.Create (numberOfClients + 2);
+  networkNodes.Create (numberOfStations + 2);
 
   /* Determin access point and server node */
   Ptr<Node> apNode = networkNodes.Get (0);
@@ -125,7 +187,7 @@ main (int argc, char *argv[])
       staContainer.Add (*i);
     }
 
-  /* Determin client nodes for object creation with client helper class */
+  /* Determin client nodes for object creation with client helper class, every station runs clientsPerNode clients */
   std::vector <std::pair <Ptr<Node>, std::string> > clients;
   for (NodeContainer::Iterator i = networkNodes.Begin () + 2; i != networkNodes.End (); ++i)
     {
@@ -141,35 +203,64 @@ main (int argc, char *argv[])
   NetDeviceContainer wanIpDevices;
   wanIpDevices = p2p.Install (serverNode, apNode);
 
-  /* create MAC layers */
-  WifiMacHelper wifiMac;
-  /* WLAN configuration */
-  Ssid ssid = Ssid ("network");
-  /* Configure STAs for WLAN*/
+  /* Additional servers, each with its own WAN link to the access point */
+  NodeContainer serverNodes;
+  serverNodes.Add (serverNode);
+  NodeContainer additionalServerNodes;
+  additionalServerNodes.Create (numberOfServers - 1);
+  serverNodes.Add (additionalServerNodes);
+  std::vector<NetDeviceContainer> additionalWanDevices;
+  for (uint32_t i = 0; i < additionalServerNodes.GetN (); i++)
+    {
+      additionalWanDevices.push_back (p2p.Install (additionalServerNodes.Get (i), apNode));
+    }
 
-  wifiMac.SetType ("ns3::StaWifiMac",
-                    "Ssid", SsidValue (ssid));
-  NetDeviceContainer staDevices;
-  staDevices = wifiHelper.Install (wifiPhy, wifiMac, staContainer);
+  /* Determin WLAN devices (AP and STAs) */
+  NetDeviceContainer wlanDevices;
+  /* Point-to-point access links instead of the WLAN, one per client, to separate the costs of the wifi model */
+  std::vector<NetDeviceContainer> accessDevices;
+  if (topology == "wifi")
+    {
+      /* create MAC layers */
+      WifiMacHelper wifiMac;
+      /* WLAN configuration */
+      Ssid ssid = Ssid ("network");
+      /* Configure STAs for WLAN*/
 
-  /* Configure AP for WLAN*/
-  wifiMac.SetType ("ns3::ApWifiMac",
-                    "Ssid", SsidValue (ssid));
-  NetDeviceContainer apDevice;
-  apDevice = wifiHelper.Install (wifiPhy, wifiMac, apNode);
+      wifiMac.SetType ("ns3::StaWifiMac",
+                        "Ssid", SsidValue (ssid));
+      NetDeviceContainer staDevices;
+      staDevices = wifiHelper.Install (wifiPhy, wifiMac, staContainer);
 
+      /* Configure AP for WLAN*/
+      wifiMac.SetType ("ns3::ApWifiMac",
+                        "Ssid", SsidValue (ssid));
+      NetDeviceContainer apDevice;
+      apDevice = wifiHelper.Install (wifiPhy, wifiMac, apNode);
 
 
-  Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/ChannelWidth", UintegerValue (40));
 
-  /* Determin WLAN devices (AP and STAs) */
-  NetDeviceContainer wlanDevices;
-  wlanDevices.Add (staDevices);
-  wlanDevices.Add (apDevice);
+      Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/ChannelWidth", UintegerValue (40));
+
+      wlanDevices.Add (staDevices);
+      wlanDevices.Add (apDevice);
+    }
+  else
+    {
+      PointToPointHelper accessLink;
+      accessLink.SetDeviceAttribute ("DataRate", StringValue (accessDataRate));
+      accessLink.SetDeviceAttribute ("Mtu", UintegerValue (1500));
+      accessLink.SetChannelAttribute ("Delay", StringValue ("2ms"));
+      for (uint32_t i = 0; i < staContainer.GetN (); i++)
+        {
+          accessDevices.push_back (accessLink.Install (staContainer.Get (i), apNode));
+        }
+    }
 
   /* Internet stack */
   InternetStackHelper stack;
   stack.Install (networkNodes);
+  stack.Install (additionalServerNodes);
 
   /* Assign IP addresses */
   Ipv4AddressHelper address;
@@ -178,10 +269,45 @@ main (int argc, char *argv[])
   address.SetBase ("76.1.1.0", "255.255.255.0");
   Ipv4InterfaceContainer wanInterface = address.Assign (wanIpDevices);
   Address serverAddress = Address(wanInterface.GetAddress (0));
+  std::vector<Address> serverAddresses;
+  serverAddresses.push_back (serverAddress);
+  for (uint32_t i = 0; i < additionalWanDevices.size (); i++)
+    {
+      address.SetBase (Ipv4Address (("76.1." + ToString (i + 2) + ".0").c_str ()), "255.255.255.0");
+      Ipv4InterfaceContainer additionalWanInterface = address.Assign (additionalWanDevices.at (i));
+      serverAddresses.push_back (Address(additionalWanInterface.GetAddress (0)));
+    }
 
-  /* IPs for WLAN (STAs and AP) */
-  address.SetBase ("192.168.1.0", "255.255.255.0");
-  address.Assign (wlanDevices);
+  Address apAddress;
+  if (topology == "wifi")
+    {
+      /* IPs for WLAN (STAs and AP), a /24 network only holds 253 stations */
+      if (numberOfStations < 254)
+        {
+          address.SetBase ("192.168.1.0", "255.255.255.0");
+        }
+      else
+        {
+          address.SetBase ("10.1.0.0", "255.255.0.0");
+        }
+      Ipv4InterfaceContainer wlanInterface = address.Assign (wlanDevices);
+      /* The AP is the last of the WLAN devices */
+      apAddress = Address(wlanInterface.GetAddress (numberOfStations));
+    }
+  else
+    {
+      /* One /30 network per access link, the AP is the second device of every link */
+      address.SetBase ("10.0.0.0", "255.255.255.252");
+      for (uint32_t i = 0; i < accessDevices.size (); i++)
+        {
+          Ipv4InterfaceContainer accessInterface = address.Assign (accessDevices.at (i));
+          address.NewNetwork ();
+          if (i == 0)
+            {
+              apAddress = Address(accessInterface.GetAddress (1));
+            }
+        }
+    }
 
   /* Populate routing table */
   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
@@ -238,8 +364,8 @@ main (int argc, char *argv[])
   clientPosLog.open (clientPos.c_str());
   NS_ASSERT_MSG (clientPosLog.is_open(), "Couldn't open clientPosLog file");
 
-  // allocate clients to positions
-  for (uint i = 0; i < numberOfClients; i++)
+  // allocate stations to positions, all clients of a station share its position
+  for (uint i = 0; i < numberOfStations; i++)
     {
       Vector pos = Vector (randPosAlloc->GetNext());
       positionAlloc->Add (pos);
@@ -265,27 +391,135 @@ main (int argc, char *argv[])
 
 
 
-  /* Install TCP Receiver on the access point */
-  TcpStreamServerHelper serverHelper (port);
-  ApplicationContainer serverApp = serverHelper.Install (serverNode);
+  /* Install TCP Receiver on the server(s) */
+  TcpStreamServerPoolHelper serverPoolHelper (port);
+  ApplicationContainer serverApp;
+  if (numberOfServers > 1)
+    {
+      std::vector<double> weights;
+      std::stringstream weightStream (serverWeights);
+      std::string weight;
+      while (std::getline (weightStream, weight, ','))
+        {
+          weights.push_back (atof (weight.c_str ()));
+        }
+      serverPoolHelper.SetAttribute ("ServerHints", BooleanValue (serverHints));
+      serverPoolHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+      serverPoolHelper.SetPoolAttribute ("Policy", StringValue (loadBalancing));
+      serverApp = serverPoolHelper.Install (serverNodes, serverAddresses, weights);
+    }
+  else
+    {
+      TcpStreamServerHelper serverHelper (port);
+      serverHelper.SetAttribute ("ServerHints", BooleanValue (serverHints));
+      serverHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+      serverApp = serverHelper.Install (serverNode);
+    }
   serverApp.Start (Seconds (1.0));
+  /* Install the edge cache on the access point, the clients then request their segments from the AP */
+  Ptr<TcpStreamCacheProxy> proxy;
+  if (cacheProxy)
+    {
+      TcpStreamCacheProxyHelper proxyHelper (port, serverAddress, port);
+      proxyHelper.SetAttribute ("CacheCapacity", UintegerValue (cacheCapacity));
+      ApplicationContainer proxyApp = proxyHelper.Install (apNode);
+      proxyApp.Start (Seconds (1.0));
+      proxy = proxyApp.Get (0)->GetObject<TcpStreamCacheProxy> ();
+    }
   /* Install TCP/UDP Transmitter on the station */
-  TcpStreamClientHelper clientHelper (serverAddress, port);
+  TcpStreamClientHelper clientHelper (cacheProxy ? apAddress : serverAddress, port);
   clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
   clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("SegmentQualityFilePath", StringValue (segmentQualityFilePath));
   clientHelper.SetAttribute ("NumberOfClients", UintegerValue(numberOfClients));
   clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
-  ApplicationContainer clientApps = clientHelper.Install (clients);
+  clientHelper.SetAttribute ("Live", BooleanValue (live));
+  clientHelper.SetAttribute ("AvailabilityStartTime", TimeValue (Seconds (liveStartTime)));
+  clientHelper.SetAttribute ("TargetLatency", TimeValue (Seconds (targetLatency)));
+  clientHelper.SetAttribute ("Chunks", UintegerValue (chunks));
+  clientHelper.SetAttribute ("Push", BooleanValue (push));
+  clientHelper.SetAttribute ("BatchSize", UintegerValue (batchSize));
+  clientHelper.SetAttribute ("BatchThreshold", TimeValue (Seconds (batchThreshold)));
+  if (numberOfServers > 1 && serverSwitching)
+    {
+      for (uint32_t i = 0; i < serverAddresses.size (); i++)
+        {
+          clientHelper.AddCandidateServer (serverAddresses.at (i), port);
+        }
+    }
+  Ptr<VideoCatalog> catalog;
+  if (!catalogFilePath.empty ())
+    {
+      catalog = CreateObjectWithAttributes<VideoCatalog> ("CatalogFilePath", StringValue (catalogFilePath),
+                                                          "AssignmentFilePath", StringValue (titleAssignment),
+                                                          "ZipfExponent", DoubleValue (zipfExponent));
+      catalog->AssignStreams (simulationId);
+      clientHelper.SetCatalog (catalog);
+    }
+  ApplicationContainer clientApps = clientHelper.Install (clients, clientsPerNode);
+  if (numberOfServers > 1 && !serverSwitching)
+    {
+      serverPoolHelper.AssignClients (clientApps);
+    }
   for (uint i = 0; i < clientApps.GetN (); i++)
     {
       double startTime = 2.0 + ((i * 3) / 100.0);
       clientApps.Get (i)->SetStartTime (Seconds (startTime));
     }
+  // the servers keep running, the simulation is done when every client finished its session
+  TcpStreamSessionHelper::StopWhenFinished (clientApps);
 
 
   NS_LOG_INFO ("Run Simulation.");
   NS_LOG_INFO ("Sim: " << simulationId << "Clients: " << numberOfClients);
   Simulator::Run ();
+  if (cacheProxy)
+    {
+      std::ofstream cacheLog;
+      std::string cacheLogPath = dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/" + "sim" + ToString (simulationId) + "_" + "cacheLog.txt";
+      cacheLog.open (cacheLogPath.c_str ());
+      proxy->PrintStatistics (cacheLog);
+      cacheLog.close ();
+    }
+  if (numberOfServers > 1)
+    {
+      std::ofstream loadLog;
+      std::string loadLogPath = dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/" + "sim" + ToString (simulationId) + "_" + "serverLoadLog.txt";
+      loadLog.open (loadLogPath.c_str ());
+      serverPoolHelper.GetPool ()->ReportLoad (loadLog);
+      loadLog.close ();
+    }
+  if (catalog != 0)
+    {
+      std::ofstream catalogLog;
+      std::string catalogLogPath = dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/" + "sim" + ToString (simulationId) + "_" + "catalogLog.txt";
+      catalogLog.open (catalogLogPath.c_str ());
+      catalogLog << "Title Viewers Segment_Size_File\n";
+      for (uint32_t i = 0; i < catalog->GetN (); i++)
+        {
+          catalogLog << std::setfill (' ') << std::setw (5) << i << " "
+                     << std::setfill (' ') << std::setw (7) << catalog->GetViewers (i) << " "
+                     << catalog->GetSegmentSizeFilePath (i) << "\n";
+        }
+      catalogLog << "Loaded_Manifests " << VideoCatalog::GetLoadedManifests () << "\n";
+      catalogLog.close ();
+    }
+  // cost of the simulation, to size the machines running it
+  struct timespec wallClockEnd;
+  clock_gettime (CLOCK_MONOTONIC, &wallClockEnd);
+  double wallClock = (wallClockEnd.tv_sec - wallClockStart.tv_sec) + (wallClockEnd.tv_nsec - wallClockStart.tv_nsec) / 1e9;
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  std::ofstream runtimeLog;
+  std::string runtimeLogPath = dashLogDirectory + adaptationAlgo + "/" + ToString (numberOfClients) + "/" + "sim" + ToString (simulationId) + "_" + "runtimeLog.txt";
+  runtimeLog.open (runtimeLogPath.c_str ());
+  runtimeLog << "Topology Wall_Clock Simulated_Time Simulated_Seconds_Per_Second Peak_RSS_kB\n";
+  runtimeLog << std::setfill (' ') << std::setw (8) << topology << " "
+             << std::setfill (' ') << std::setw (10) << wallClock << " "
+             << std::setfill (' ') << std::setw (14) << Simulator::Now ().GetSeconds () << " "
+             << std::setfill (' ') << std::setw (28) << Simulator::Now ().GetSeconds () / wallClock << " "
+             << std::setfill (' ') << std::setw (11) << usage.ru_maxrss << "\n";
+  runtimeLog.close ();
   Simulator::Destroy ();
   NS_LOG_INFO ("Done.");
 
@@ -20,11 +20,21 @@
 #include "tcp-stream-helper.h"
 #include "ns3/tcp-stream-server.h"
 #include "ns3/tcp-stream-client.h"
+#include "ns3/tcp-stream-cache-proxy.h"
 #include "ns3/uinteger.h"
+#include "ns3/string.h"
 #include "ns3/names.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/simple-ref-count.h"
+#include <fstream>
+#include <set>
+#include <cmath>
 
 namespace ns3 {
 
+NS_LOG_COMPONENT_DEFINE ("TcpStreamHelper");
+
 TcpStreamServerHelper::TcpStreamServerHelper (uint16_t port)
 {
   m_factory.SetTypeId (TcpStreamServer::GetTypeId ());
@@ -100,26 +110,322 @@ TcpStreamClientHelper::SetAttribute (std::string name, const AttributeValue &val
   m_factory.Set (name, value);
 }
 
+void
+TcpStreamClientHelper::AddCandidateServer (Address ip, uint16_t port)
+{
+  m_candidates.push_back (std::make_pair (ip, port));
+}
+
+void
+TcpStreamClientHelper::SetCatalog (Ptr<VideoCatalog> catalog)
+{
+  m_catalog = catalog;
+}
+
 ApplicationContainer
 TcpStreamClientHelper::Install (std::vector <std::pair <Ptr<Node>, std::string> > clients) const
 {
+  return Install (clients, 1);
+}
+
+ApplicationContainer
+TcpStreamClientHelper::Install (std::vector <std::pair <Ptr<Node>, std::string> > clients, uint32_t clientsPerNode) const
+{
+  NS_ABORT_MSG_IF (clientsPerNode == 0, "At least one client has to be installed per node");
   ApplicationContainer apps;
   for (uint i = 0; i < clients.size (); i++)
     {
-      apps.Add (InstallPriv (clients.at (i).first, clients.at (i).second, i));
+      // in a distributed simulation, every rank only runs the clients of its own nodes, keeping the ids of all clients
+      if (clients.at (i).first->GetSystemId () != Simulator::GetSystemId ())
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < clientsPerNode; j++)
+        {
+          apps.Add (InstallPriv (clients.at (i).first, clients.at (i).second, i * clientsPerNode + j));
+        }
     }
 
   return apps;
 }
 
 Ptr<Application>
-TcpStreamClientHelper::InstallPriv (Ptr<Node> node, std::string algo, uint16_t clientId) const
+TcpStreamClientHelper::InstallPriv (Ptr<Node> node, std::string algo, uint32_t clientId) const
 {
   Ptr<Application> app = m_factory.Create<TcpStreamClient> ();
   app->GetObject<TcpStreamClient> ()->SetAttribute ("ClientId", UintegerValue (clientId));
+  if (m_catalog != 0)
+    {
+      // the manifest of the title is read once and shared with all other clients streaming it
+      uint32_t title = m_catalog->AssignTitle (clientId);
+      app->GetObject<TcpStreamClient> ()->SetAttribute ("VideoId", UintegerValue (title));
+      app->GetObject<TcpStreamClient> ()->SetAttribute ("SegmentSizeFilePath", StringValue (m_catalog->GetSegmentSizeFilePath (title)));
+      app->GetObject<TcpStreamClient> ()->SetAttribute ("SegmentQualityFilePath", StringValue (m_catalog->GetSegmentQualityFilePath (title)));
+    }
   app->GetObject<TcpStreamClient> ()->Initialise (algo, clientId);
+  for (uint i = 0; i < m_candidates.size (); i++)
+    {
+      app->GetObject<TcpStreamClient> ()->AddCandidateServer (m_candidates.at (i).first, m_candidates.at (i).second);
+    }
   node->AddApplication (app);
   return app;
 }
 
+TcpStreamSessionHelper::TcpStreamSessionHelper ()
+{
+  m_arrivalProcess = FIXED_INTERVAL;
+  m_rate = 0;
+  m_amplitude = 0;
+  m_interArrival = CreateObject<ExponentialRandomVariable> ();
+  m_thinning = CreateObject<UniformRandomVariable> ();
+}
+
+void
+TcpStreamSessionHelper::SetPoissonArrivals (double rate)
+{
+  NS_ASSERT_MSG (rate > 0, "The arrival rate must be > 0");
+  m_arrivalProcess = POISSON;
+  m_rate = rate;
+}
+
+void
+TcpStreamSessionHelper::SetDiurnalArrivals (double rate, double amplitude, Time period)
+{
+  NS_ASSERT_MSG (rate > 0, "The arrival rate must be > 0");
+  NS_ASSERT_MSG (amplitude >= 0 && amplitude <= 1, "The amplitude of the diurnal rate must be between 0 and 1");
+  NS_ASSERT_MSG (period.IsStrictlyPositive (), "The period of the diurnal rate must be > 0");
+  m_arrivalProcess = DIURNAL;
+  m_rate = rate;
+  m_amplitude = amplitude;
+  m_period = period;
+}
+
+void
+TcpStreamSessionHelper::SetTraceArrivals (std::string path)
+{
+  std::ifstream trace (path.c_str ());
+  NS_ABORT_MSG_IF (!trace, "Couldn't open the arrival trace " << path);
+  m_arrivalProcess = TRACE;
+  m_arrivalTrace.clear ();
+  double arrival;
+  while (trace >> arrival)
+    {
+      NS_ABORT_MSG_IF (!m_arrivalTrace.empty () && arrival < m_arrivalTrace.back (), "The arrivals in " << path << " are not sorted");
+      m_arrivalTrace.push_back (arrival);
+    }
+}
+
+void
+TcpStreamSessionHelper::SetSessionLength (Ptr<RandomVariableStream> length)
+{
+  m_sessionLength = length;
+}
+
+int64_t
+TcpStreamSessionHelper::AssignStreams (int64_t stream)
+{
+  m_interArrival->SetStream (stream);
+  m_thinning->SetStream (stream + 1);
+  if (m_sessionLength != 0)
+    {
+      m_sessionLength->SetStream (stream + 2);
+      return 3;
+    }
+  return 2;
+}
+
+Time
+TcpStreamSessionHelper::NextArrival (Time now)
+{
+  if (m_arrivalProcess == POISSON)
+    {
+      return now + Seconds (m_interArrival->GetValue (1 / m_rate, 0));
+    }
+  // thinning: candidates arrive with the peak rate, each one is kept with the ratio of the current rate to it
+  double peakRate = m_rate * (1 + m_amplitude);
+  double t = now.GetSeconds ();
+  while (true)
+    {
+      t += m_interArrival->GetValue (1 / peakRate, 0);
+      double rate = m_rate * (1 + m_amplitude * std::sin (2 * M_PI * t / m_period.GetSeconds ()));
+      if (m_thinning->GetValue (0, peakRate) < rate)
+        {
+          return Seconds (t);
+        }
+    }
+}
+
+void
+TcpStreamSessionHelper::Schedule (ApplicationContainer clients, Time start, Time interval, Time end)
+{
+  NS_ABORT_MSG_IF (m_arrivalProcess == TRACE && m_arrivalTrace.size () < clients.GetN (),
+                   "The arrival trace holds fewer arrivals than there are clients");
+  Time arrival = start;
+  for (uint32_t i = 0; i < clients.GetN (); i++)
+    {
+      if (i > 0)
+        {
+          switch (m_arrivalProcess)
+            {
+            case FIXED_INTERVAL:
+              arrival += interval;
+              break;
+            case TRACE:
+              arrival = start + Seconds (m_arrivalTrace.at (i) - m_arrivalTrace.at (0));
+              break;
+            default:
+              arrival = NextArrival (arrival);
+            }
+        }
+      if (arrival >= end)
+        {
+          // the simulation is over before this client arrives, so are the later ones
+          NS_LOG_INFO ((clients.GetN () - i) << " clients arrive after the end of the simulation");
+          for (uint32_t j = i; j < clients.GetN (); j++)
+            {
+              clients.Get (j)->SetStartTime (end + Seconds (1));
+            }
+          return;
+        }
+      clients.Get (i)->SetStartTime (arrival);
+      if (m_sessionLength != 0)
+        {
+          // a stop time of 0 would mean no stop time at all
+          clients.Get (i)->SetStopTime (arrival + Seconds (std::max (m_sessionLength->GetValue (), 1e-6)));
+        }
+    }
+}
+
+/**
+ * \brief Counts the clients one call of StopWhenFinished waits for.
+ *
+ * The counter is owned by the callbacks connected to the clients, so it lives as long as they do and every
+ * call, e.g. of a later simulation run in the same process, counts on its own.
+ */
+class UnfinishedSessions : public SimpleRefCount<UnfinishedSessions>
+{
+public:
+  /**
+   * \param sessions the number of clients to wait for
+   */
+  UnfinishedSessions (uint32_t sessions) : m_sessions (sessions) {}
+
+  /**
+   * \brief Stop the simulation when the last client finished its session.
+   */
+  void SessionFinished (uint32_t clientId)
+  {
+    NS_LOG_LOGIC ("Client " << clientId << " finished, " << m_sessions - 1 << " to go");
+    if (m_sessions > 0 && --m_sessions == 0)
+      {
+        Simulator::Stop ();
+      }
+  }
+
+private:
+  uint32_t m_sessions; //!< Number of clients that did not finish their session yet
+};
+
+void
+TcpStreamSessionHelper::StopWhenFinished (ApplicationContainer clients)
+{
+  if (clients.GetN () == 0)
+    {
+      return;
+    }
+  // a client listed twice finishes only once
+  std::set<Ptr<Application> > unique (clients.Begin (), clients.End ());
+  Ptr<UnfinishedSessions> sessions = Create<UnfinishedSessions> (unique.size ());
+  for (std::set<Ptr<Application> >::iterator it = unique.begin (); it != unique.end (); ++it)
+    {
+      (*it)->TraceConnectWithoutContext ("SessionFinished", MakeCallback (&UnfinishedSessions::SessionFinished, sessions));
+    }
+}
+
+TcpStreamCacheProxyHelper::TcpStreamCacheProxyHelper (uint16_t port, Address originAddress, uint16_t originPort)
+{
+  m_factory.SetTypeId (TcpStreamCacheProxy::GetTypeId ());
+  SetAttribute ("Port", UintegerValue (port));
+  SetAttribute ("OriginAddress", AddressValue (originAddress));
+  SetAttribute ("OriginPort", UintegerValue (originPort));
+}
+
+void
+TcpStreamCacheProxyHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+TcpStreamCacheProxyHelper::Install (Ptr<Node> node) const
+{
+  Ptr<Application> app = m_factory.Create<TcpStreamCacheProxy> ();
+  node->AddApplication (app);
+  return ApplicationContainer (app);
+}
+
+ApplicationContainer
+TcpStreamCacheProxyHelper::Install (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      apps.Add (Install (*i));
+    }
+  return apps;
+}
+
+TcpStreamServerPoolHelper::TcpStreamServerPoolHelper (uint16_t port)
+{
+  m_port = port;
+  m_factory.SetTypeId (TcpStreamServer::GetTypeId ());
+  m_poolFactory.SetTypeId (TcpStreamServerPool::GetTypeId ());
+  SetAttribute ("Port", UintegerValue (port));
+}
+
+void
+TcpStreamServerPoolHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+void
+TcpStreamServerPoolHelper::SetPoolAttribute (std::string name, const AttributeValue &value)
+{
+  m_poolFactory.Set (name, value);
+}
+
+ApplicationContainer
+TcpStreamServerPoolHelper::Install (NodeContainer c, std::vector<Address> addresses, std::vector<double> weights)
+{
+  NS_ASSERT_MSG (addresses.size () == c.GetN (), "One address per server node is needed");
+  NS_ASSERT_MSG (weights.empty () || weights.size () == c.GetN (), "One weight per server node is needed");
+  m_pool = m_poolFactory.Create<TcpStreamServerPool> ();
+  ApplicationContainer apps;
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      Ptr<TcpStreamServer> server = m_factory.Create<TcpStreamServer> ();
+      c.Get (i)->AddApplication (server);
+      m_pool->AddServer (server, addresses.at (i), m_port, weights.empty () ? 1.0 : weights.at (i));
+      apps.Add (server);
+    }
+  return apps;
+}
+
+void
+TcpStreamServerPoolHelper::AssignClients (ApplicationContainer clients) const
+{
+  NS_ASSERT_MSG (m_pool != 0, "Install the servers before assigning clients");
+  for (ApplicationContainer::Iterator i = clients.Begin (); i != clients.End (); ++i)
+    {
+      (*i)->GetObject<TcpStreamClient> ()->SetServerSelector (MakeCallback (&TcpStreamServerPool::SelectServer, m_pool));
+    }
+}
+
+Ptr<TcpStreamServerPool>
+TcpStreamServerPoolHelper::GetPool (void) const
+{
+  return m_pool;
+}
+
 } // namespace ns3
@@ -26,6 +26,10 @@
 #include "ns3/object-factory.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/tcp-stream-server-pool.h"
+#include "ns3/video-catalog.h"
 
 namespace ns3 {
 
@@ -139,17 +143,49 @@ public:
    */
   void SetAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * Add a server every client installed afterwards may switch to during the
+   * streaming session, see TcpStreamClient::AddCandidateServer.
+   *
+   * \param ip the address of the server
+   * \param port the port of the server
+   */
+  void AddCandidateServer (Address ip, uint16_t port);
+
+  /**
+   * Let every client installed afterwards stream a title of the catalog, chosen by
+   * VideoCatalog::AssignTitle, instead of the video of the SegmentSizeFilePath attribute.
+   *
+   * \param catalog the catalog of the videos
+   */
+  void SetCatalog (Ptr<VideoCatalog> catalog);
+
   /**
    * \param clients the nodes with the name of the adaptation algorithm to be used
    *
    * Create one tcp stream client application on each of the input nodes and
    * instantiate an adaptation algorithm on each of the tcp stream client according
-   * to the given string.
+   * to the given string. The index of a node in clients is the id of its client.
+   * In a distributed simulation, only the nodes of the local rank get a client.
    *
-   * \returns the applications created, one application per input node.
+   * \returns the applications created, one application per input node of the local rank.
    */
   ApplicationContainer Install (std::vector <std::pair <Ptr<Node>, std::string> > clients) const;
 
+  /**
+   * \param clients the nodes with the name of the adaptation algorithm to be used
+   * \param clientsPerNode the number of clients installed on every node
+   *
+   * Create clientsPerNode tcp stream client applications on each of the input nodes, e.g. for the
+   * screens of a household behind one station. The clients of a node share its stack and devices, but
+   * each one has its own socket and id: the clients of the node with index i get the ids
+   * i * clientsPerNode to (i + 1) * clientsPerNode - 1, which keeps their log files apart.
+   * In a distributed simulation, only the nodes of the local rank get clients.
+   *
+   * \returns the applications created, clientsPerNode applications per input node of the local rank.
+   */
+  ApplicationContainer Install (std::vector <std::pair <Ptr<Node>, std::string> > clients, uint32_t clientsPerNode) const;
+
 private:
   /**
    * Install an ns3::TcpStreamClient on the node configured with all the
@@ -161,8 +197,217 @@ private:
    * \param simulationId distinguish this simulation from other subsequently started simulations, for logging purposes
    * \returns Ptr to the application installed.
    */
-  Ptr<Application> InstallPriv (Ptr<Node> node, std::string algo, uint16_t clientId) const;
+  Ptr<Application> InstallPriv (Ptr<Node> node, std::string algo, uint32_t clientId) const;
   ObjectFactory m_factory; //!< Object factory.
+  std::vector <std::pair <Address, uint16_t> > m_candidates; //!< Servers added to every client as switching candidates
+  Ptr<VideoCatalog> m_catalog; //!< The catalog the titles of the clients are chosen from, 0 if all clients stream the same video
+};
+
+/**
+ * \ingroup TcpStream
+ * \brief Schedule the sessions of tcp stream clients: when every client arrives and how long it watches
+ *
+ * Without an arrival process, the clients are started one after the other in a fixed interval. Without a
+ * session length, every client watches the whole video.
+ */
+class TcpStreamSessionHelper
+{
+public:
+  TcpStreamSessionHelper ();
+
+  /**
+   * Start the clients according to a Poisson process.
+   *
+   * \param rate the mean number of arriving clients per second
+   */
+  void SetPoissonArrivals (double rate);
+
+  /**
+   * Start the clients according to a Poisson process whose rate follows the time of day, i.e.
+   * rate * (1 + amplitude * sin (2 pi t / period)) at simulation time t.
+   *
+   * \param rate the mean number of arriving clients per second over a period
+   * \param amplitude the relative deviation of the rate from its mean at peak time, between 0 and 1
+   * \param period the length of a day
+   */
+  void SetDiurnalArrivals (double rate, double amplitude, Time period);
+
+  /**
+   * Start the clients at the points in time listed in a file, one per line in seconds after the first arrival.
+   *
+   * \param path the relative path (from ns-3.x directory) to the file
+   */
+  void SetTraceArrivals (std::string path);
+
+  /**
+   * Stop every client after a random time, e.g. "ns3::ExponentialRandomVariable[Mean=600]", once it started.
+   * A client whose session is longer than the video finishes as usual.
+   *
+   * \param length the time in seconds a client watches
+   */
+  void SetSessionLength (Ptr<RandomVariableStream> length);
+
+  /**
+   * Assign fixed random variable stream numbers to the random variables used by this helper.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this helper
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * Set the start and stop time of every client. Clients arriving after end are never started.
+   *
+   * \param clients the tcp stream client applications, in order of their arrival
+   * \param start the point in time the first client arrives
+   * \param interval the time between two arrivals without arrival process
+   * \param end the end of the simulation, Time::Max () if it ends when the clients are done
+   */
+  void Schedule (ApplicationContainer clients, Time start, Time interval, Time end);
+
+  /**
+   * Stop the simulation once every one of the clients finished its session. Servers do not know
+   * whether more clients will come, so they never end the simulation on their own. Every call waits for
+   * its own clients, independent of earlier calls.
+   *
+   * \param clients the tcp stream client applications
+   */
+  static void StopWhenFinished (ApplicationContainer clients);
+
+private:
+  /**
+   * \param now the point in time the previous client arrived
+   * \return the point in time the next client arrives
+   */
+  Time NextArrival (Time now);
+
+  /**
+   * \brief The arrival process of the clients.
+   */
+  enum ArrivalProcess
+  {
+    FIXED_INTERVAL, //!< One client after the other, in a fixed interval
+    POISSON, //!< Exponentially distributed times between the arrivals
+    DIURNAL, //!< Poisson arrivals whose rate follows the time of day
+    TRACE //!< Arrival times read from a file
+  };
+
+  ArrivalProcess m_arrivalProcess; //!< The arrival process of the clients
+  double m_rate; //!< Mean number of arrivals per second
+  double m_amplitude; //!< Relative deviation of the diurnal rate from its mean
+  Time m_period; //!< Length of a day of the diurnal arrivals
+  std::vector<double> m_arrivalTrace; //!< Arrival times in seconds after the first arrival
+  Ptr<ExponentialRandomVariable> m_interArrival; //!< Time between two arrivals of the Poisson processes
+  Ptr<UniformRandomVariable> m_thinning; //!< Decides whether a diurnal arrival candidate arrives
+  Ptr<RandomVariableStream> m_sessionLength; //!< Time a client watches, 0 if clients watch the whole video
+};
+
+/**
+ * \ingroup TcpStream
+ * \brief Create a caching proxy application, which is placed between the tcp stream clients and server
+ */
+class TcpStreamCacheProxyHelper
+{
+public:
+  /**
+   * Create TcpStreamCacheProxyHelper which will make life easier for people trying
+   * to set up simulations with an edge cache.
+   *
+   * \param port The port the proxy will wait on for incoming requests
+   * \param originAddress The address of the tcp stream server cache misses are fetched from
+   * \param originPort The port of the tcp stream server cache misses are fetched from
+   */
+  TcpStreamCacheProxyHelper (uint16_t port, Address originAddress, uint16_t originPort);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Create a TcpStreamCacheProxy on the specified Node, e.g. the access point.
+   *
+   * \param node The node on which to create the Application.
+   *
+   * \returns An ApplicationContainer holding the Application created,
+   */
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+  /**
+   * \param c The nodes on which to create the Applications.
+   *
+   * Create one cache proxy application on each of the Nodes in the NodeContainer.
+   *
+   * \returns The applications created, one Application per Node in the NodeContainer.
+   */
+  ApplicationContainer Install (NodeContainer c) const;
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+};
+
+/**
+ * \ingroup TcpStream
+ * \brief Create a pool of tcp stream servers and assign clients to them according to a load balancing policy
+ */
+class TcpStreamServerPoolHelper
+{
+public:
+  /**
+   * Create TcpStreamServerPoolHelper which will make life easier for people trying
+   * to set up simulations with several servers.
+   *
+   * \param port The port the servers will wait on for incoming packets
+   */
+  TcpStreamServerPoolHelper (uint16_t port);
+
+  /**
+   * Record an attribute to be set in each server Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Record an attribute to be set in the TcpStreamServerPool, e.g. its "Policy".
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetPoolAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Create one tcp stream server application on each of the nodes and add it to a new pool.
+   *
+   * \param c The nodes on which to create the servers.
+   * \param addresses The addresses the clients reach the servers with, one per node.
+   * \param weights The capacity weights of the servers, one per node. If empty, all servers have the same weight.
+   *
+   * \returns The server applications created, one Application per Node in the NodeContainer.
+   */
+  ApplicationContainer Install (NodeContainer c, std::vector<Address> addresses, std::vector<double> weights = std::vector<double> ());
+
+  /**
+   * Let the pool choose the server of every client when the client starts.
+   *
+   * \param clients The tcp stream client applications.
+   */
+  void AssignClients (ApplicationContainer clients) const;
+
+  /**
+   * \returns The pool created by the last call of Install.
+   */
+  Ptr<TcpStreamServerPool> GetPool (void) const;
+
+private:
+  uint16_t m_port; //!< The port the servers listen on
+  ObjectFactory m_factory; //!< Object factory for the servers.
+  ObjectFactory m_poolFactory; //!< Object factory for the pool.
+  Ptr<TcpStreamServerPool> m_pool; //!< The pool created by Install
 };
 
 } // namespace ns3
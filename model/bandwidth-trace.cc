@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "bandwidth-trace.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/trace-source-accessor.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BandwidthTrace");
+
+NS_OBJECT_ENSURE_REGISTERED (BandwidthTraceReplay);
+
+Ptr<const BandwidthTrace>
+BandwidthTrace::Load (std::string path)
+{
+  NS_LOG_FUNCTION (path);
+  // every file is read once, all replays of it share the same trace
+  static std::map<std::string, Ptr<const BandwidthTrace> > traces;
+  std::map<std::string, Ptr<const BandwidthTrace> >::iterator it = traces.find (path);
+  if (it != traces.end ())
+    {
+      return it->second;
+    }
+  std::ifstream myfile;
+  myfile.open (path.c_str ());
+  if (!myfile)
+    {
+      return 0;
+    }
+  Ptr<BandwidthTrace> trace = Create<BandwidthTrace> ();
+  double time, throughput;
+  while (myfile >> time >> throughput)
+    {
+      if (!trace->m_start.empty () && Seconds (time) <= trace->m_start.back ())
+        {
+          NS_LOG_ERROR ("The times of the trace " << path << " are not increasing");
+          return 0;
+        }
+      trace->m_start.push_back (Seconds (time));
+      trace->m_rate.push_back (DataRate ((uint64_t)(throughput * 1000000)));
+    }
+  if (trace->m_start.size () < 2 || !trace->m_start.front ().IsZero ())
+    {
+      NS_LOG_ERROR ("The trace " << path << " must start at time 0 and hold at least two lines");
+      return 0;
+    }
+  // the last line only marks the end of the trace
+  trace->m_period = trace->m_start.back ();
+  trace->m_start.pop_back ();
+  trace->m_rate.pop_back ();
+  NS_LOG_INFO ("Read trace " << path << " of " << trace->m_start.size () << " intervals");
+  traces [path] = trace;
+  return trace;
+}
+
+uint32_t
+BandwidthTrace::GetInterval (Time time) const
+{
+  Time position = TimeStep (time.GetTimeStep () % m_period.GetTimeStep ());
+  return std::upper_bound (m_start.begin (), m_start.end (), position) - m_start.begin () - 1;
+}
+
+Time
+BandwidthTrace::GetIntervalStart (uint32_t interval) const
+{
+  return m_start.at (interval);
+}
+
+DataRate
+BandwidthTrace::GetRate (uint32_t interval) const
+{
+  return m_rate.at (interval);
+}
+
+uint32_t
+BandwidthTrace::GetN (void) const
+{
+  return m_start.size ();
+}
+
+Time
+BandwidthTrace::GetPeriod (void) const
+{
+  return m_period;
+}
+
+TypeId
+BandwidthTraceReplay::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BandwidthTraceReplay")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<BandwidthTraceReplay> ()
+    .AddAttribute ("TraceFilePath",
+                   "The relative path (from ns-3.x directory) to the trace file, one \"time throughput\" pair per line in seconds and Mbps",
+                   StringValue (""),
+                   MakeStringAccessor (&BandwidthTraceReplay::m_traceFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("Offset",
+                   "The point in the trace the replay starts at, to keep devices replaying the same trace apart",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&BandwidthTraceReplay::m_offset),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("MinRate",
+                   "The lowest data rate set on the device, lower throughputs of the trace are replayed at this rate",
+                   DataRateValue (DataRate ("10kbps")),
+                   MakeDataRateAccessor (&BandwidthTraceReplay::m_minRate),
+                   MakeDataRateChecker ())
+    .AddTraceSource ("RateChanged",
+                     "The data rate of the device was set to the throughput of the next interval of the trace",
+                     MakeTraceSourceAccessor (&BandwidthTraceReplay::m_rateChangedTrace),
+                     "ns3::BandwidthTraceReplay::RateChangedCallback")
+  ;
+  return tid;
+}
+
+BandwidthTraceReplay::BandwidthTraceReplay ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BandwidthTraceReplay::~BandwidthTraceReplay ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+BandwidthTraceReplay::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_nextUpdate);
+  m_device = 0;
+  m_trace = 0;
+  Object::DoDispose ();
+}
+
+void
+BandwidthTraceReplay::Install (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  m_trace = BandwidthTrace::Load (m_traceFilePath);
+  NS_ABORT_MSG_IF (m_trace == 0, "Couldn't read the bandwidth trace " << m_traceFilePath);
+  m_device = device;
+  m_installed = Simulator::Now ();
+  Simulator::Cancel (m_nextUpdate);
+  Update ();
+}
+
+void
+BandwidthTraceReplay::Update (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time position = TimeStep ((m_offset + Simulator::Now () - m_installed).GetTimeStep () % m_trace->GetPeriod ().GetTimeStep ());
+  uint32_t interval = m_trace->GetInterval (position);
+  DataRate rate = std::max (m_trace->GetRate (interval), m_minRate);
+  m_device->SetAttribute ("DataRate", DataRateValue (rate));
+  m_rateChangedTrace (rate);
+
+  Time next = interval + 1 < m_trace->GetN () ? m_trace->GetIntervalStart (interval + 1) : m_trace->GetPeriod ();
+  m_nextUpdate = Simulator::Schedule (next - position, &BandwidthTraceReplay::Update, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BANDWIDTH_TRACE_H
+#define BANDWIDTH_TRACE_H
+
+#include "ns3/object.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/net-device.h"
+#include "ns3/traced-callback.h"
+#include <stdint.h>
+#include <vector>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief A recorded throughput trace, read once per file and shared by everything replaying it.
+ *
+ * The file holds one "time throughput" pair per line, time in seconds and throughput in Mbps, like the traces
+ * of the DashEmulator; each throughput holds until the time of the next line, and the trace repeats after the
+ * time of its last line.
+ */
+class BandwidthTrace : public SimpleRefCount<BandwidthTrace>
+{
+public:
+  /**
+   * \brief Get the trace of a file, reading the file on first use only.
+   *
+   * \param path the relative path (from ns-3.x directory) to the trace file
+   * \return the trace, 0 if the file could not be read or holds no valid trace
+   */
+  static Ptr<const BandwidthTrace> Load (std::string path);
+
+  /**
+   * \param time a point in time, counted from the start of the trace
+   * \return the index of the interval the point in time falls into, the trace repeating after its period
+   */
+  uint32_t GetInterval (Time time) const;
+
+  /**
+   * \param interval the index of an interval
+   * \return the start of the interval, counted from the start of the trace
+   */
+  Time GetIntervalStart (uint32_t interval) const;
+
+  /**
+   * \param interval the index of an interval
+   * \return the throughput during the interval
+   */
+  DataRate GetRate (uint32_t interval) const;
+
+  uint32_t GetN (void) const; //!< \return the number of intervals of the trace
+  Time GetPeriod (void) const; //!< \return the time after which the trace repeats
+
+private:
+  std::vector<Time> m_start; //!< Start of every interval
+  std::vector<DataRate> m_rate; //!< Throughput of every interval
+  Time m_period; //!< The time after which the trace repeats
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Replays a bandwidth trace on the data rate of a net device, e.g. of a point-to-point link.
+ *
+ * The "DataRate" attribute of the device is set to the throughput of the trace whenever an interval of the
+ * trace begins. Only the next change is scheduled at a time. A packet in transmission when the rate changes
+ * keeps its old rate. Rates below MinRate, e.g. outages recorded as 0, are replayed as MinRate, since a device
+ * can not send at rate 0.
+ */
+class BandwidthTraceReplay : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  BandwidthTraceReplay ();
+  virtual ~BandwidthTraceReplay ();
+
+  /**
+   * \brief Start replaying the trace on a device, from the current point in time on.
+   *
+   * \param device the device whose data rate follows the trace
+   */
+  void Install (Ptr<NetDevice> device);
+
+  /**
+   * TracedCallback signature for a change of the data rate.
+   *
+   * \param [in] rate the new data rate of the device
+   */
+  typedef void (* RateChangedCallback)(DataRate rate);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Set the rate of the current interval and schedule the start of the next one.
+   */
+  void Update (void);
+
+  std::string m_traceFilePath; //!< The relative path (from ns-3.x directory) to the trace file
+  Time m_offset; //!< The point in the trace the replay starts at
+  DataRate m_minRate; //!< The lowest rate set on the device
+  Ptr<const BandwidthTrace> m_trace; //!< The trace replayed
+  Ptr<NetDevice> m_device; //!< The device whose data rate follows the trace
+  Time m_installed; //!< The point in time the replay started
+  EventId m_nextUpdate; //!< The start of the next interval of the trace
+  TracedCallback<DataRate> m_rateChangedTrace; //!< The data rate of the device was changed
+};
+
+} // namespace ns3
+
+#endif /* BANDWIDTH_TRACE_H */
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "bola.h"
+#include "ns3/double.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BolaAlgorithm");
+
+NS_OBJECT_ENSURE_REGISTERED (BolaAlgorithm);
+NS_ADAPTATION_ALGORITHM_REGISTER (BolaAlgorithm, "bola");
+
+TypeId
+BolaAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BolaAlgorithm")
+    .SetParent<AdaptationAlgorithm> ()
+    .SetGroupName ("Applications")
+    .AddAttribute ("V",
+                   "The Lyapunov trade-off parameter between utility and buffer level, in segments. 0 derives it from BufferTarget",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&BolaAlgorithm::m_v),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Gamma",
+                   "The weight of playback smoothness, i.e. of avoiding rebuffering, in units of utility per segment",
+                   DoubleValue (5.0),
+                   MakeDoubleAccessor (&BolaAlgorithm::m_gamma),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("BufferTarget",
+                   "The buffer level from which on the highest representation is chosen, used to derive V",
+                   TimeValue (Seconds (30)),
+                   MakeTimeAccessor (&BolaAlgorithm::m_bufferTarget),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+BolaAlgorithm::BolaAlgorithm (  const videoData &videoData,
+                                const playbackData & playbackData,
+                                const bufferData & bufferData,
+                                const throughputData & throughput) :
+  AdaptationAlgorithm (videoData, playbackData, bufferData, throughput),
+  m_v (0.0),
+  m_gamma (5.0),
+  m_bufferTarget (Seconds (30)),
+  m_highestRepIndex (videoData.averageBitrate.size () - 1),
+  m_bufferMax (0.0)
+{
+  NS_LOG_INFO (this);
+  NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be => 0");
+}
+
+void
+BolaAlgorithm::NotifyConstructionCompleted (void)
+{
+  m_utility.clear ();
+  for (int64_t i = 0; i <= m_highestRepIndex; i++)
+    {
+      m_utility.push_back (log (m_videoData.averageBitrate.at (i) / m_videoData.averageBitrate.at (0)));
+    }
+  if (m_v <= 0.0)
+    {
+      // choose V such that the highest representation scores positive up to one segment below the buffer target
+      double bufferTarget = std::max (2.0, (double) m_bufferTarget.GetMicroSeconds () / m_videoData.segmentDuration);
+      m_v = (bufferTarget - 1.0) / (m_utility.back () + m_gamma);
+    }
+  m_bufferMax = m_v * (m_utility.back () + m_gamma);
+  AdaptationAlgorithm::NotifyConstructionCompleted ();
+}
+
+algorithmReply
+BolaAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
+{
+  int64_t timeNow = Now ();
+  algorithmReply answer;
+  answer.decisionTime = timeNow;
+  answer.nextDownloadDelay = 0;
+  answer.delayDecisionCase = 0;
+
+  if (segmentCounter == 0 || m_bufferData.bufferLevelNew.empty ())
+    {
+      answer.nextRepIndex = 0;
+      answer.decisionCase = 0;
+      return answer;
+    }
+  int64_t bufferNow = std::max ((int64_t) 0, m_bufferData.bufferLevelNew.back () - (timeNow - m_throughput.transmissionEnd.back ()));
+  double bufferSegments = (double) bufferNow / m_videoData.segmentDuration;
+
+  // a single pass over the representations, the bitrate stands in for the segment size as both differ by the segment duration only
+  int64_t bestIndex = 0;
+  double bestScore = (m_v * (m_utility.at (0) + m_gamma) - bufferSegments) / m_videoData.averageBitrate.at (0);
+  for (int64_t i = 1; i <= m_highestRepIndex; i++)
+    {
+      double score = (m_v * (m_utility.at (i) + m_gamma) - bufferSegments) / m_videoData.averageBitrate.at (i);
+      if (score >= bestScore)
+        {
+          bestScore = score;
+          bestIndex = i;
+        }
+    }
+  answer.nextRepIndex = bestIndex;
+  answer.decisionCase = 1;
+
+  // no representation scores positive, wait until the buffer drained to the level one would
+  if (bufferSegments > m_bufferMax)
+    {
+      answer.nextDownloadDelay = bufferNow - (int64_t)(m_bufferMax * m_videoData.segmentDuration);
+      answer.delayDecisionCase = 1;
+    }
+  return answer;
+}
+
+} // namespace ns3
@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BOLA_ALGORITHM_H
+#define BOLA_ALGORITHM_H
+
+#include "tcp-stream-adaptation-algorithm.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Implementation of the BOLA adaptation algorithm
+ *
+ * BOLA (Spiteri et al., "BOLA: Near-Optimal Bitrate Adaptation for Online Videos") chooses the representation
+ * maximising (V (v_m + gamma) - Q) / S_m, with v_m = ln (S_m / S_0) the utility of representation m, S_m its
+ * bitrate and Q the buffer level in segments. If the buffer is above the level at which even the highest
+ * representation scores negative, the download of the next segment is delayed.
+ *
+ * The client has to create the algorithm with CompleteConstruct, so its attributes are set.
+ */
+class BolaAlgorithm : public AdaptationAlgorithm
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  BolaAlgorithm (  const videoData &videoData,
+                   const playbackData & playbackData,
+                   const bufferData & bufferData,
+                   const throughputData & throughput);
+
+  algorithmReply GetNextRep (const int64_t segmentCounter, int64_t clientId);
+
+protected:
+  /**
+   * \brief Precompute the utilities and derive V from the buffer target once the attributes are set.
+   */
+  virtual void NotifyConstructionCompleted (void);
+
+private:
+  double m_v; //!< The Lyapunov trade-off parameter V in segments, 0 derives it from m_bufferTarget
+  double m_gamma; //!< The weight gamma of playback smoothness, in units of utility per segment
+  Time m_bufferTarget; //!< The buffer level from which on the highest representation is chosen
+  const int64_t m_highestRepIndex;
+  std::vector<double> m_utility; //!< The utility of every representation, ln (S_m / S_0)
+  double m_bufferMax; //!< The buffer level in segments above which no representation scores positive, V (v_M + gamma)
+};
+
+} // namespace ns3
+#endif /* BOLA_ALGORITHM_H */
@@ -0,0 +1,542 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dash-emulator.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include <sstream>
+#include <iterator>
+#include <numeric>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DashEmulator");
+
+NS_OBJECT_ENSURE_REGISTERED (DashEmulator);
+
+TypeId
+DashEmulator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DashEmulator")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<DashEmulator> ()
+    .AddAttribute ("SegmentDuration",
+                   "The duration of a segment in microseconds",
+                   UintegerValue (2000000),
+                   MakeUintegerAccessor (&DashEmulator::m_segmentDuration),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("SegmentSizeFilePath",
+                   "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes",
+                   StringValue ("bitrates.txt"),
+                   MakeStringAccessor (&DashEmulator::m_segmentSizeFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("TraceFilePath",
+                   "The relative path (from ns-3.x directory) to the throughput trace, lines of time in seconds and throughput in Mbps",
+                   StringValue ("trace.txt"),
+                   MakeStringAccessor (&DashEmulator::m_traceFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("Rtt",
+                   "The time between sending a request and receiving the first byte of the segment",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&DashEmulator::m_rtt),
+                   MakeTimeChecker ())
+    .AddAttribute ("SimulationId",
+                   "The ID of the current simulation, for logging purposes",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DashEmulator::m_simulationId),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("NumberOfClients",
+                   "The number of traces emulated in this simulation, for logging purposes",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&DashEmulator::m_numberOfClients),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+DashEmulator::DashEmulator ()
+{
+  NS_LOG_FUNCTION (this);
+  m_now = 0;
+  m_uid = 0;
+  m_scheduledEvents = 0;
+  m_tracePeriod = 0;
+  state = initial;
+  m_clientId = 0;
+  m_segmentCounter = 0;
+  m_currentRepIndex = 0;
+  m_currentPlaybackIndex = 0;
+  m_segmentsInBuffer = 0;
+  m_lastSegmentIndex = 0;
+  m_highestRepIndex = 0;
+  m_bDelay = 0;
+  m_bufferUnderrun = false;
+  m_downloadRequestSent = 0;
+  m_transmissionStartReceivingSegment = 0;
+  m_transmissionEndReceivingSegment = 0;
+  m_playbackData.firstSegmentIndex = 0;
+}
+
+DashEmulator::~DashEmulator ()
+{
+  NS_LOG_FUNCTION (this);
+  algo = 0;
+}
+
+bool
+DashEmulator::Run (std::string algorithm, uint32_t clientId)
+{
+  NS_LOG_FUNCTION (this << algorithm << clientId);
+  m_videoData.segmentDuration = m_segmentDuration;
+  if (ReadInBitrateValues (m_segmentSizeFilePath) == -1)
+    {
+      NS_LOG_ERROR ("Opening test bitrate file failed.");
+      return false;
+    }
+  if (ReadTrace (m_traceFilePath) == -1)
+    {
+      NS_LOG_ERROR ("Opening trace file failed.");
+      return false;
+    }
+  m_lastSegmentIndex = (int64_t) m_videoData.segmentSize.at (0).size () - 1;
+  m_highestRepIndex = m_videoData.averageBitrate.size () - 1;
+  algo = AdaptationAlgorithm::Create (algorithm, m_videoData, m_playbackData, m_bufferData, m_throughput);
+  if (algo == 0)
+    {
+      NS_LOG_ERROR ("Invalid algorithm name entered.");
+      return false;
+    }
+  algo->SetClock (MakeCallback (&DashEmulator::GetTime, this));
+  m_algoName = algorithm;
+  m_clientId = clientId;
+
+  std::ostringstream simulationId, clientIdString, numberOfClients;
+  simulationId << m_simulationId;
+  clientIdString << m_clientId;
+  numberOfClients << m_numberOfClients;
+  InitializeLogFiles (simulationId.str (), clientIdString.str (), numberOfClients.str ());
+
+  Controller (init);
+  while (!m_events.empty () && state != terminal)
+    {
+      emulatorEvent next = m_events.top ();
+      m_events.pop ();
+      m_now = next.time;
+      if (next.segmentReceived)
+        {
+          m_segmentsInBuffer++;
+          SegmentReceivedHandle ();
+        }
+      else
+        {
+          Controller (next.event);
+        }
+    }
+  LogSession ();
+  return true;
+}
+
+void
+DashEmulator::Controller (controllerEvent event)
+{
+  NS_LOG_FUNCTION (this);
+  if (state == initial)
+    {
+      RequestRepIndex ();
+      state = downloading;
+      RequestSegment ();
+      return;
+    }
+
+  if (state == downloading)
+    {
+      PlaybackHandle ();
+      if (m_currentPlaybackIndex <= m_lastSegmentIndex)
+        {
+          /*  e_d  */
+          m_segmentCounter++;
+          RequestRepIndex ();
+          state = downloadingPlaying;
+          RequestSegment ();
+        }
+      else
+        {
+          /*  e_df  */
+          state = playing;
+        }
+      Schedule (m_videoData.segmentDuration, false, playbackFinished);
+      return;
+    }
+
+  else if (state == downloadingPlaying)
+    {
+      if (event == downloadFinished)
+        {
+          if (m_segmentCounter < m_lastSegmentIndex)
+            {
+              m_segmentCounter++;
+              RequestRepIndex ();
+            }
+
+          if (m_bDelay > 0 && m_segmentCounter <= m_lastSegmentIndex)
+            {
+              /*  e_dirs */
+              state = playing;
+              Schedule (m_bDelay, false, irdFinished);
+            }
+          else if (m_segmentCounter == m_lastSegmentIndex)
+            {
+              /*  e_df  */
+              state = playing;
+            }
+          else
+            {
+              /*  e_d  */
+              RequestSegment ();
+            }
+        }
+      else if (event == playbackFinished)
+        {
+          if (!PlaybackHandle ())
+            {
+              /*  e_pb  */
+              Schedule (m_videoData.segmentDuration, false, playbackFinished);
+            }
+          else
+            {
+              /*  e_pu  */
+              state = downloading;
+            }
+        }
+      return;
+    }
+
+  else if (state == playing)
+    {
+      if (event == irdFinished)
+        {
+          /*  e_irc  */
+          state = downloadingPlaying;
+          RequestSegment ();
+        }
+      else if (event == playbackFinished && m_currentPlaybackIndex < m_lastSegmentIndex)
+        {
+          /*  e_pb  */
+          PlaybackHandle ();
+          Schedule (m_videoData.segmentDuration, false, playbackFinished);
+        }
+      else if (event == playbackFinished && m_currentPlaybackIndex == m_lastSegmentIndex)
+        {
+          PlaybackHandle ();
+          /*  e_pf  */
+          state = terminal;
+        }
+      return;
+    }
+}
+
+void
+DashEmulator::Schedule (int64_t delay, bool segmentReceived, controllerEvent event)
+{
+  emulatorEvent next;
+  next.time = m_now + delay;
+  next.uid = m_uid++;
+  next.segmentReceived = segmentReceived;
+  next.event = event;
+  m_events.push (next);
+  m_scheduledEvents++;
+}
+
+int64_t
+DashEmulator::GetTime (void) const
+{
+  return m_now;
+}
+
+void
+DashEmulator::RequestRepIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  algorithmReply answer = algo->GetNextRep (m_segmentCounter, m_clientId);
+  m_currentRepIndex = answer.nextRepIndex;
+  NS_ASSERT_MSG (answer.nextRepIndex <= m_highestRepIndex, "The algorithm returned a representation index that's higher than the maximum");
+  m_playbackData.playbackIndex.push_back (answer.nextRepIndex);
+  m_bDelay = answer.nextDownloadDelay;
+  LogAdaptation (answer);
+}
+
+void
+DashEmulator::RequestSegment ()
+{
+  NS_LOG_FUNCTION (this);
+  m_downloadRequestSent = m_now;
+  m_transmissionStartReceivingSegment = m_now + m_rtt.GetMicroSeconds ();
+  double bits = 8.0 * m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter);
+  int64_t end = TransmissionEnd (m_transmissionStartReceivingSegment, bits);
+  Schedule (end - m_now, true, downloadFinished);
+}
+
+int64_t
+DashEmulator::TransmissionEnd (int64_t start, double bits) const
+{
+  // find the trace interval the transmission starts in, then consume the intervals until all bits are sent
+  int64_t periodStart = start - start % m_tracePeriod;
+  uint32_t i = std::upper_bound (m_traceTime.begin (), m_traceTime.end (), start - periodStart) - m_traceTime.begin () - 1;
+  int64_t time = start;
+  while (true)
+    {
+      int64_t intervalEnd = periodStart + (i + 1 < m_traceTime.size () ? m_traceTime.at (i + 1) : m_tracePeriod);
+      double capacity = m_traceRate.at (i) * (intervalEnd - time);
+      if (capacity >= bits)
+        {
+          return time + (int64_t) ceil (bits / m_traceRate.at (i));
+        }
+      bits -= capacity;
+      time = intervalEnd;
+      i++;
+      if (i == m_traceTime.size ())
+        {
+          i = 0;
+          periodStart += m_tracePeriod;
+        }
+    }
+}
+
+void
+DashEmulator::SegmentReceivedHandle ()
+{
+  NS_LOG_FUNCTION (this);
+  m_transmissionEndReceivingSegment = m_now;
+  m_bufferData.timeNow.push_back (m_transmissionEndReceivingSegment);
+  if (m_segmentCounter > 0)
+    { //if a buffer underrun is encountered, the old buffer level will be set to 0, because the buffer can not be negative
+      m_bufferData.bufferLevelOld.push_back (std::max (m_bufferData.bufferLevelNew.back () -
+                                                       (m_transmissionEndReceivingSegment - m_throughput.transmissionEnd.back ()), (int64_t)0));
+    }
+  else //first segment
+    {
+      m_bufferData.bufferLevelOld.push_back (0);
+    }
+  m_bufferData.bufferLevelNew.push_back (m_bufferData.bufferLevelOld.back () + m_videoData.segmentDuration);
+
+  m_throughput.bytesReceived.push_back (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
+  m_throughput.transmissionStart.push_back (m_transmissionStartReceivingSegment);
+  m_throughput.transmissionRequested.push_back (m_downloadRequestSent);
+  m_throughput.transmissionEnd.push_back (m_transmissionEndReceivingSegment);
+  m_throughput.transmissionIdle.push_back (0);
+
+  LogThroughput (m_throughput.bytesReceived.back ());
+  LogDownload ();
+  LogBuffer ();
+
+  if (m_segmentCounter == m_lastSegmentIndex)
+    {
+      m_bDelay = 0;
+    }
+  Controller (downloadFinished);
+}
+
+bool
+DashEmulator::PlaybackHandle ()
+{
+  NS_LOG_FUNCTION (this);
+  // if we got called and there are no segments left in the buffer, there is a buffer underrun
+  if (m_segmentsInBuffer == 0 && m_currentPlaybackIndex < m_lastSegmentIndex && !m_bufferUnderrun)
+    {
+      m_bufferUnderrun = true;
+      bufferUnderrunLog << std::setfill (' ') << std::setw (26) << m_now / (double)1000000 << " ";
+      return true;
+    }
+  else if (m_segmentsInBuffer > 0)
+    {
+      if (m_bufferUnderrun)
+        {
+          m_bufferUnderrun = false;
+          bufferUnderrunLog << std::setfill (' ') << std::setw (13) << m_now / (double)1000000 << "\n";
+        }
+      m_segmentsInBuffer--;
+      m_playbackData.playbackStart.push_back (m_now);
+      LogPlayback ();
+      m_currentPlaybackIndex++;
+      return false;
+    }
+
+  return true;
+}
+
+int
+DashEmulator::ReadInBitrateValues (std::string segmentSizeFile)
+{
+  NS_LOG_FUNCTION (this);
+  std::ifstream myfile;
+  myfile.open (segmentSizeFile.c_str ());
+  if (!myfile)
+    {
+      return -1;
+    }
+  std::string temp;
+  int64_t averageByteSizeTemp = 0;
+  while (std::getline (myfile, temp))
+    {
+      if (temp.empty ())
+        {
+          break;
+        }
+      std::istringstream buffer (temp);
+      std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
+                                 std::istream_iterator<int64_t>());
+      m_videoData.segmentSize.push_back (line);
+      averageByteSizeTemp = (int64_t) std::accumulate ( line.begin (), line.end (), 0.0) / line.size ();
+      m_videoData.averageBitrate.push_back ((8.0 * averageByteSizeTemp) / (m_videoData.segmentDuration / 1000000.0));
+    }
+  NS_ASSERT_MSG (!m_videoData.segmentSize.empty (), "No segment sizes read from file.");
+  return 1;
+}
+
+int
+DashEmulator::ReadTrace (std::string traceFile)
+{
+  NS_LOG_FUNCTION (this);
+  std::ifstream myfile;
+  myfile.open (traceFile.c_str ());
+  if (!myfile)
+    {
+      return -1;
+    }
+  double time, throughput;
+  while (myfile >> time >> throughput)
+    {
+      m_traceTime.push_back ((int64_t)(time * 1000000));
+      m_traceRate.push_back (throughput);
+    }
+  NS_ASSERT_MSG (m_traceTime.size () > 1 && m_traceTime.front () == 0, "The trace must start at time 0 and hold at least two lines.");
+  // the last line only marks the end of the trace
+  m_tracePeriod = m_traceTime.back ();
+  m_traceTime.pop_back ();
+  m_traceRate.pop_back ();
+  NS_ASSERT_MSG (std::accumulate (m_traceRate.begin (), m_traceRate.end (), 0.0) > 0, "The throughput of the trace is always 0.");
+  return 1;
+}
+
+void
+DashEmulator::LogThroughput (uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this);
+  throughputLog << std::setfill (' ') << std::setw (13) << m_now / (double) 1000000 << " "
+                << std::setfill (' ') << std::setw (13) << bytes << "\n";
+}
+
+void
+DashEmulator::LogDownload ()
+{
+  NS_LOG_FUNCTION (this);
+  downloadLog << std::setfill (' ') << std::setw (13) << m_segmentCounter << " "
+              << std::setfill (' ') << std::setw (21) << m_downloadRequestSent / (double)1000000 << " "
+              << std::setfill (' ') << std::setw (14) << m_transmissionStartReceivingSegment / (double)1000000 << " "
+              << std::setfill (' ') << std::setw (12) << m_transmissionEndReceivingSegment / (double)1000000 << " "
+              << std::setfill (' ') << std::setw (12) << m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter) << " "
+              << std::setfill (' ') << std::setw (12) << "Y\n";
+}
+
+void
+DashEmulator::LogBuffer ()
+{
+  NS_LOG_FUNCTION (this);
+  bufferLog << std::setfill (' ') << std::setw (13) << m_transmissionEndReceivingSegment / (double)1000000 << " "
+            << std::setfill (' ') << std::setw (13) << m_bufferData.bufferLevelOld.back () / (double)1000000 << "\n"
+            << std::setfill (' ') << std::setw (13) << m_transmissionEndReceivingSegment / (double)1000000 << " "
+            << std::setfill (' ') << std::setw (13) << m_bufferData.bufferLevelNew.back () / (double)1000000 << "\n";
+}
+
+void
+DashEmulator::LogAdaptation (algorithmReply answer)
+{
+  NS_LOG_FUNCTION (this);
+  adaptationLog << std::setfill (' ') << std::setw (13) << m_segmentCounter << " "
+                << std::setfill (' ') << std::setw (9) << m_currentRepIndex << " "
+                << std::setfill (' ') << std::setw (22) << answer.decisionTime / (double)1000000 << " "
+                << std::setfill (' ') << std::setw (4) << answer.decisionCase << " "
+                << std::setfill (' ') << std::setw (9) << answer.delayDecisionCase << "\n";
+}
+
+void
+DashEmulator::LogPlayback ()
+{
+  NS_LOG_FUNCTION (this);
+  playbackLog << std::setfill (' ') << std::setw (13) << m_currentPlaybackIndex << " "
+              << std::setfill (' ') << std::setw (14) << m_now / (double)1000000 << " "
+              << std::setfill (' ') << std::setw (13) << m_playbackData.playbackIndex.at (m_currentPlaybackIndex) << "\n";
+}
+
+void
+DashEmulator::LogSession ()
+{
+  NS_LOG_FUNCTION (this);
+  int64_t linkIdle = 0;
+  int64_t transmissionTime = 0;
+  for (uint i = 0; i < m_throughput.transmissionEnd.size (); i++)
+    {
+      linkIdle += m_throughput.transmissionStart.at (i) - m_throughput.transmissionRequested.at (i);
+      transmissionTime += m_throughput.transmissionEnd.at (i) - m_throughput.transmissionStart.at (i);
+    }
+  int64_t bytes = std::accumulate (m_throughput.bytesReceived.begin (), m_throughput.bytesReceived.end (), (int64_t)0);
+  double averageThroughput = transmissionTime > 0 ? (8.0 * bytes) / (transmissionTime / (double)1000000) : 0;
+  double startupDelay = m_playbackData.playbackStart.empty () ? -1 : m_playbackData.playbackStart.front () / (double)1000000;
+  sessionLog << std::setfill (' ') << std::setw (13) << startupDelay << " "
+             << std::setfill (' ') << std::setw (14) << linkIdle / (double)1000000 << " "
+             << std::setfill (' ') << std::setw (8) << m_throughput.transmissionEnd.size () << " "
+             << std::setfill (' ') << std::setw (18) << averageThroughput << " "
+             << std::setfill (' ') << std::setw (8) << m_throughput.transmissionEnd.size () << " "
+             << std::setfill (' ') << std::setw (16) << m_scheduledEvents << " "
+             << std::setfill (' ') << std::setw (15) << -1 << "\n";
+}
+
+void
+DashEmulator::InitializeLogFiles (std::string simulationId, std::string clientId, std::string numberOfClients)
+{
+  NS_LOG_FUNCTION (this);
+  std::string prefix = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_";
+
+  downloadLog.open ((prefix + "downloadLog.txt").c_str ());
+  downloadLog << "Segment_Index Download_Request_Sent Download_Start Download_End Segment_Size Download_OK\n";
+
+  playbackLog.open ((prefix + "playbackLog.txt").c_str ());
+  playbackLog << "Segment_Index Playback_Start Quality_Level\n";
+
+  adaptationLog.open ((prefix + "adaptationLog.txt").c_str ());
+  adaptationLog << "Segment_Index Rep_Level Decision_Point_Of_Time Case DelayCase\n";
+
+  bufferLog.open ((prefix + "bufferLog.txt").c_str ());
+  bufferLog << "     Time_Now  Buffer_Level \n";
+
+  throughputLog.open ((prefix + "throughputLog.txt").c_str ());
+  throughputLog << "     Time_Now Bytes Received \n";
+
+  bufferUnderrunLog.open ((prefix + "bufferUnderrunLog.txt").c_str ());
+  bufferUnderrunLog << ("Buffer_Underrun_Started_At         Until \n");
+
+  sessionLog.open ((prefix + "sessionLog.txt").c_str ());
+  sessionLog << "Startup_Delay Link_Idle_Time Segments Average_Throughput Requests Scheduled_Events Average_Quality\n";
+}
+
+} // namespace ns3
@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DASH_EMULATOR_H
+#define DASH_EMULATOR_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include <fstream>
+#include <queue>
+#include <vector>
+#include "tcp-stream-adaptation-algorithm.h"
+#include "tcp-stream-interface.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Streams a video with an adaptation algorithm against a throughput trace, without packet-level simulation.
+ *
+ * The emulator runs the state machine, buffer and playback logic of TcpStreamClient (video on demand, without
+ * chunks, push or batching) on its own event queue and computes download times analytically: the first byte of
+ * a segment arrives one Rtt after the request, the rest at the throughput of the trace. A session takes
+ * milliseconds instead of minutes, so an algorithm can be evaluated over thousands of traces. The algorithm reads
+ * the emulator's clock, see AdaptationAlgorithm::SetClock.
+ *
+ * The trace file holds one "time throughput" pair per line, time in seconds and throughput in Mbps; each
+ * throughput holds until the time of the next line, and the trace repeats after the time of its last line.
+ * The logs are written in the formats of TcpStreamClient, to the same directories.
+ */
+class DashEmulator : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  DashEmulator ();
+  virtual ~DashEmulator ();
+
+  /**
+   * \brief Stream the whole video and write the logs.
+   *
+   * \param algorithm the name of the adaptation algorithm, see AdaptationAlgorithm::Create
+   * \param clientId the client id used in the names of the log files, e.g. the index of the trace
+   * \return false if the segment size or trace file could not be read or the algorithm is unknown
+   */
+  bool Run (std::string algorithm, uint32_t clientId);
+
+private:
+  /**
+   * \brief The states of the state machine, as in TcpStreamClient.
+   */
+  enum controllerState
+  {
+    initial, downloading, downloadingPlaying, playing, terminal
+  };
+  /**
+   * \brief The events of the state machine, as in TcpStreamClient.
+   */
+  enum controllerEvent
+  {
+    downloadFinished, playbackFinished, irdFinished, init
+  };
+  /**
+   * \brief An event in the queue of the emulator.
+   */
+  struct emulatorEvent
+  {
+    int64_t time; //!< point in time in microseconds the event happens
+    uint64_t uid; //!< events at the same time happen in the order they were scheduled in
+    bool segmentReceived; //!< true if the segment being downloaded arrives completely, else event is passed to the controller
+    controllerEvent event; //!< the event passed to the controller
+    /**
+     * \return true if this event happens after other
+     */
+    bool operator> (const emulatorEvent & other) const
+    {
+      return time > other.time || (time == other.time && uid > other.uid);
+    }
+  };
+
+  /**
+   * \brief The state machine of TcpStreamClient::Controller.
+   */
+  void Controller (controllerEvent event);
+  /**
+   * \brief Schedule an event, see emulatorEvent.
+   */
+  void Schedule (int64_t delay, bool segmentReceived, controllerEvent event);
+  /**
+   * \return the time of the emulator in microseconds, the clock of the algorithm
+   */
+  int64_t GetTime (void) const;
+  /**
+   * \brief Ask the algorithm for the representation of the next segment.
+   */
+  void RequestRepIndex ();
+  /**
+   * \brief Request the next segment and schedule its arrival.
+   */
+  void RequestSegment ();
+  /**
+   * \brief Account a completely received segment, as TcpStreamClient::SegmentReceivedHandle.
+   */
+  void SegmentReceivedHandle ();
+  /**
+   * \brief Play the next segment, as TcpStreamClient::PlaybackHandle.
+   * \return true if there is a buffer underrun
+   */
+  bool PlaybackHandle ();
+  /**
+   * \brief Point in time the last of a number of bits arrives.
+   *
+   * \param start point in time in microseconds the transmission starts
+   * \param bits the number of bits to transmit
+   * \return point in time in microseconds the transmission ends
+   */
+  int64_t TransmissionEnd (int64_t start, double bits) const;
+  /**
+   * \brief Read the segment sizes, as TcpStreamClient::ReadInBitrateValues.
+   */
+  int ReadInBitrateValues (std::string segmentSizeFile);
+  /**
+   * \brief Read the throughput trace.
+   */
+  int ReadTrace (std::string traceFile);
+  void LogThroughput (uint32_t bytes);
+  void LogDownload ();
+  void LogBuffer ();
+  void LogAdaptation (algorithmReply answer);
+  void LogPlayback ();
+  void LogSession ();
+  void InitializeLogFiles (std::string simulationId, std::string clientId, std::string numberOfClients);
+
+  uint64_t m_segmentDuration; //!< The duration of a segment in microseconds
+  std::string m_segmentSizeFilePath; //!< The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes
+  std::string m_traceFilePath; //!< The relative path (from ns-3.x directory) to the throughput trace
+  Time m_rtt; //!< The time between a request and the first byte of the segment
+  uint32_t m_simulationId; //!< The id of the simulation, for logging purposes
+  uint32_t m_numberOfClients; //!< The number of traces emulated, for logging purposes
+
+  std::priority_queue<emulatorEvent, std::vector<emulatorEvent>, std::greater<emulatorEvent> > m_events; //!< The events not happened yet
+  int64_t m_now; //!< The time of the emulator in microseconds
+  uint64_t m_uid; //!< The uid of the next event scheduled
+  uint64_t m_scheduledEvents; //!< The number of events scheduled
+  std::vector<int64_t> m_traceTime; //!< Start of every trace interval in microseconds
+  std::vector<double> m_traceRate; //!< Throughput of every trace interval in bits per microsecond
+  int64_t m_tracePeriod; //!< The time in microseconds after which the trace repeats
+
+  controllerState state;
+  Ptr<AdaptationAlgorithm> algo;
+  std::string m_algoName;
+  uint32_t m_clientId;
+  videoData m_videoData;
+  playbackData m_playbackData;
+  bufferData m_bufferData;
+  throughputData m_throughput;
+  int64_t m_segmentCounter; //!< The index of the segment being downloaded, relative to the start of the session
+  int64_t m_currentRepIndex; //!< The representation of the segment being downloaded
+  int64_t m_currentPlaybackIndex; //!< The index of the segment playing
+  int64_t m_segmentsInBuffer; //!< The number of segments in the buffer
+  int64_t m_lastSegmentIndex; //!< The index of the last segment
+  int64_t m_highestRepIndex; //!< The index of the highest representation
+  int64_t m_bDelay; //!< The delay in microseconds the algorithm asked for before requesting the next segment
+  bool m_bufferUnderrun; //!< True while the buffer is empty
+  int64_t m_downloadRequestSent; //!< Point in time in microseconds the segment being downloaded was requested
+  int64_t m_transmissionStartReceivingSegment; //!< Point in time in microseconds the first byte of the segment arrives
+  int64_t m_transmissionEndReceivingSegment; //!< Point in time in microseconds the last byte of the segment arrives
+
+  std::ofstream adaptationLog;
+  std::ofstream downloadLog;
+  std::ofstream playbackLog;
+  std::ofstream bufferLog;
+  std::ofstream throughputLog;
+  std::ofstream bufferUnderrunLog;
+  std::ofstream sessionLog;
+};
+
+} // namespace ns3
+
+#endif /* DASH_EMULATOR_H */
@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dash-profiler.h"
+#include "ns3/simulator.h"
+#include "tcp-stream-interface.h"
+#include <time.h>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace ns3 {
+
+bool DashProfiler::m_reportScheduled = false;
+
+DashProfiler::Site::Site (const char *name)
+  : name (name),
+    calls (0),
+    nanoseconds (0)
+{
+  Sites ().push_back (this);
+}
+
+DashProfiler::ScopedTimer::ScopedTimer (Site *site)
+  : m_site (site),
+    m_start (WallClock ())
+{
+  ScheduleReport ();
+}
+
+DashProfiler::ScopedTimer::~ScopedTimer ()
+{
+  m_site->calls++;
+  m_site->nanoseconds += WallClock () - m_start;
+}
+
+void
+DashProfiler::Count (Site *site)
+{
+  ScheduleReport ();
+  site->calls++;
+}
+
+void
+DashProfiler::Report (std::ostream &os)
+{
+  // sum up sites of the same name, e.g. the same event scheduled at several places
+  std::map<std::string, std::pair<uint64_t, int64_t> > totals;
+  for (uint32_t i = 0; i < Sites ().size (); i++)
+    {
+      std::pair<uint64_t, int64_t> &total = totals[Sites ().at (i)->name];
+      total.first += Sites ().at (i)->calls;
+      total.second += Sites ().at (i)->nanoseconds;
+    }
+  std::vector<std::pair<int64_t, std::string> > order;
+  for (std::map<std::string, std::pair<uint64_t, int64_t> >::iterator it = totals.begin (); it != totals.end (); ++it)
+    {
+      order.push_back (std::make_pair (-it->second.second, it->first));
+    }
+  std::sort (order.begin (), order.end ());
+
+  os << "                                    Name        Calls    Total_ms  ns_per_call\n";
+  for (uint32_t i = 0; i < order.size (); i++)
+    {
+      std::pair<uint64_t, int64_t> &total = totals[order.at (i).second];
+      os << std::setfill (' ') << std::setw (40) << order.at (i).second << " "
+         << std::setfill (' ') << std::setw (12) << total.first << " "
+         << std::setfill (' ') << std::setw (11) << total.second / 1e6 << " "
+         << std::setfill (' ') << std::setw (12) << (total.first > 0 ? total.second / (double) total.first : 0) << "\n";
+    }
+}
+
+int64_t
+DashProfiler::WallClock (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void
+DashProfiler::ScheduleReport (void)
+{
+  if (!m_reportScheduled)
+    {
+      m_reportScheduled = true;
+      Simulator::ScheduleDestroy (&DashProfiler::WriteReport);
+    }
+}
+
+void
+DashProfiler::WriteReport (void)
+{
+  // every rank of a distributed simulation reports its own counters
+  std::ostringstream path;
+  path << dashLogDirectory << "profileLog";
+  if (Simulator::GetSystemId () > 0)
+    {
+      path << "_rank" << Simulator::GetSystemId ();
+    }
+  path << ".txt";
+  std::ofstream profileLog (path.str ().c_str ());
+  Report (profileLog);
+  profileLog.close ();
+  for (uint32_t i = 0; i < Sites ().size (); i++)
+    {
+      Sites ().at (i)->calls = 0;
+      Sites ().at (i)->nanoseconds = 0;
+    }
+  m_reportScheduled = false;
+}
+
+std::vector<DashProfiler::Site *> &
+DashProfiler::Sites (void)
+{
+  static std::vector<Site *> sites;
+  return sites;
+}
+
+} // namespace ns3
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DASH_PROFILER_H
+#define DASH_PROFILER_H
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Call counts and cumulative wall clock time of the hot paths of the module.
+ *
+ * Only compiled in if the module is configured with --enable-dash-profiling, which defines
+ * DASH_PROFILING; otherwise DASH_PROFILE_SCOPE and DASH_PROFILE_COUNT expand to nothing.
+ * Every use of the macros is a site with its own counters. The counters of all sites are
+ * written to dashLogDirectory/profileLog.txt when the simulator is destroyed.
+ */
+class DashProfiler
+{
+public:
+  /**
+   * \brief The counters of one instrumented function or event.
+   */
+  struct Site
+  {
+    /**
+     * \param name the name the counters are reported under, sites with the same name are summed up
+     */
+    Site (const char *name);
+
+    const char *name; //!< The name the counters are reported under
+    uint64_t calls; //!< Number of calls or events
+    int64_t nanoseconds; //!< Wall clock time spent in the calls, including the functions they called
+  };
+
+  /**
+   * \brief Adds the wall clock time from its construction to its destruction to a site.
+   */
+  class ScopedTimer
+  {
+  public:
+    ScopedTimer (Site *site);
+    ~ScopedTimer ();
+  private:
+    Site *m_site; //!< The site the time is added to
+    int64_t m_start; //!< Wall clock time in nanoseconds the timer was constructed at
+  };
+
+  /**
+   * \brief Counts an event of a site.
+   */
+  static void Count (Site *site);
+
+  /**
+   * \brief Write the counters of all sites, sorted by cumulative time.
+   *
+   * \param os the stream the report is written to
+   */
+  static void Report (std::ostream &os);
+
+private:
+  /**
+   * \return monotonic wall clock time in nanoseconds
+   */
+  static int64_t WallClock (void);
+
+  /**
+   * \brief Make sure the report is written when the simulator is destroyed.
+   */
+  static void ScheduleReport (void);
+
+  /**
+   * \brief Write the report to the log directory and reset the counters.
+   */
+  static void WriteReport (void);
+
+  /**
+   * \return all sites constructed so far
+   */
+  static std::vector<Site *> & Sites (void);
+
+  static bool m_reportScheduled; //!< True if writing the report is scheduled for the destruction of the simulator
+};
+
+} // namespace ns3
+
+#ifdef DASH_PROFILING
+/**
+ * Time the rest of the enclosing scope, at most once per scope.
+ */
+#define DASH_PROFILE_SCOPE(name) \
+  static ns3::DashProfiler::Site dashProfileSite (name); \
+  ns3::DashProfiler::ScopedTimer dashProfileTimer (&dashProfileSite)
+/**
+ * Count an event, e.g. the scheduling of a controller event.
+ */
+#define DASH_PROFILE_COUNT(name) \
+  do \
+    { \
+      static ns3::DashProfiler::Site dashProfileSite (name); \
+      ns3::DashProfiler::Count (&dashProfileSite); \
+    } \
+  while (false)
+#else
+#define DASH_PROFILE_SCOPE(name)
+#define DASH_PROFILE_COUNT(name)
+#endif
+
+#endif /* DASH_PROFILER_H */
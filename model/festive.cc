@@ -17,12 +17,40 @@
  */
 
 #include "festive.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("FestiveAlgorithm");
 
 NS_OBJECT_ENSURE_REGISTERED (FestiveAlgorithm);
+NS_ADAPTATION_ALGORITHM_REGISTER (FestiveAlgorithm, "festive");
+
+TypeId
+FestiveAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FestiveAlgorithm")
+    .SetParent<AdaptationAlgorithm> ()
+    .SetGroupName ("Applications")
+    .AddAttribute ("TargetBuffer",
+                   "The target buffer level in microseconds, downloads are delayed above a level randomised by a segment duration around it",
+                   IntegerValue (30000000),
+                   MakeIntegerAccessor (&FestiveAlgorithm::m_targetBuf),
+                   MakeIntegerChecker<int64_t> (0))
+    .AddAttribute ("Alpha",
+                   "The weight of efficiency against stability when deciding whether to switch",
+                   DoubleValue (12.0),
+                   MakeDoubleAccessor (&FestiveAlgorithm::m_alpha),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("ThroughputThreshold",
+                   "Switch down if the current bitrate exceeds this share of the estimated throughput",
+                   DoubleValue (0.85),
+                   MakeDoubleAccessor (&FestiveAlgorithm::m_thrptThrsh),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
 
 FestiveAlgorithm::FestiveAlgorithm (  const videoData &videoData,
                                       const playbackData & playbackData,
@@ -44,7 +72,7 @@ FestiveAlgorithm::FestiveAlgorithm (  const videoData &videoData,
 algorithmReply
 FestiveAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
 {
-  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  int64_t timeNow = Now ();
   bool decisionMade = false;
   algorithmReply answer;
   answer.decisionTime = timeNow;
@@ -78,7 +106,7 @@ FestiveAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
       else
         {
           thrptEstimationTmp.push_back ((8.0 * m_throughput.bytesReceived.at (sd))
-                                        / ((double)((m_throughput.transmissionEnd.at (sd) - m_throughput.transmissionRequested.at (sd)) / 1000000.0)));
+                                        / ((double)((m_throughput.transmissionEnd.at (sd) - m_throughput.transmissionRequested.at (sd) - m_throughput.transmissionIdle.at (sd)) / 1000000.0)));
         }
       if (thrptEstimationTmp.size () == 20)
         {
@@ -30,6 +30,12 @@ namespace ns3 {
 class FestiveAlgorithm : public AdaptationAlgorithm
 {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
   FestiveAlgorithm (  const videoData &videoData,
                       const playbackData & playbackData,
                       const bufferData & bufferData,
@@ -38,11 +44,11 @@ public:
   algorithmReply GetNextRep (const int64_t segmentCounter, int64_t clientId);
 
 private:
-  const int64_t m_targetBuf;
+  int64_t m_targetBuf;
   const int64_t m_delta;
-  const double m_alpha;
+  double m_alpha;
   const int64_t m_highestRepIndex;
-  const double m_thrptThrsh;
+  double m_thrptThrsh;
   std::vector<int> m_smooth;
 };
 
@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fluid-network.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FluidNetwork");
+
+NS_OBJECT_ENSURE_REGISTERED (FluidNetwork);
+
+TypeId
+FluidNetwork::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FluidNetwork")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<FluidNetwork> ()
+  ;
+  return tid;
+}
+
+FluidNetwork::FluidNetwork ()
+  : m_activeFlows (0),
+    m_nextFlowId (0),
+    m_lastUpdate (Seconds (0)),
+    m_peakActiveFlows (0),
+    m_recomputations (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FluidNetwork::~FluidNetwork ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+FluidNetwork::AddLink (DataRate capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  Link link;
+  link.capacity = capacity.GetBitRate ();
+  link.remaining = 0;
+  link.unfixed = 0;
+  m_links.push_back (link);
+  return m_links.size () - 1;
+}
+
+uint32_t
+FluidNetwork::AddPath (std::vector<uint32_t> links, Time rtt, DataRate maxRate)
+{
+  NS_LOG_FUNCTION (this << rtt << maxRate);
+  NS_ABORT_MSG_IF (links.empty () && maxRate.GetBitRate () == 0, "A path needs a link or a maximum rate");
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      NS_ABORT_MSG_IF (links.at (i) >= m_links.size (), "The path crosses link " << links.at (i) << ", which does not exist");
+    }
+  Path path;
+  path.links = links;
+  path.rtt = rtt;
+  path.maxRate = maxRate.GetBitRate () > 0 ? maxRate.GetBitRate () : std::numeric_limits<double>::infinity ();
+  path.rate = 0;
+  path.service = 0;
+  path.fixed = false;
+  m_paths.push_back (path);
+  return m_paths.size () - 1;
+}
+
+void
+FluidNetwork::StartFlow (uint32_t path, uint64_t bytes, Callback<void> started, Callback<void> finished)
+{
+  NS_LOG_FUNCTION (this << path << bytes);
+  NS_ASSERT_MSG (path < m_paths.size (), "Path " << path << " does not exist");
+  Simulator::Schedule (m_paths.at (path).rtt, &FluidNetwork::ActivateFlow, this, path, 8.0 * bytes, started, finished);
+}
+
+uint32_t
+FluidNetwork::GetActiveFlows (void) const
+{
+  return m_activeFlows;
+}
+
+uint32_t
+FluidNetwork::GetPeakActiveFlows (void) const
+{
+  return m_peakActiveFlows;
+}
+
+uint64_t
+FluidNetwork::GetRecomputations (void) const
+{
+  return m_recomputations;
+}
+
+void
+FluidNetwork::ActivateFlow (uint32_t path, double bits, Callback<void> started, Callback<void> finished)
+{
+  NS_LOG_FUNCTION (this << path << bits);
+  Advance ();
+  FlowEnd end;
+  end.service = m_paths.at (path).service + bits;
+  end.id = m_nextFlowId++;
+  end.finished = finished;
+  m_paths.at (path).ends.push (end);
+  m_activeFlows++;
+  m_peakActiveFlows = std::max (m_peakActiveFlows, m_activeFlows);
+  Recompute ();
+  ScheduleCompletion ();
+  started ();
+}
+
+void
+FluidNetwork::Advance (void)
+{
+  double elapsed = (Simulator::Now () - m_lastUpdate).GetSeconds ();
+  m_lastUpdate = Simulator::Now ();
+  if (elapsed <= 0)
+    {
+      return;
+    }
+  for (uint32_t p = 0; p < m_paths.size (); p++)
+    {
+      m_paths.at (p).service += m_paths.at (p).rate * elapsed;
+    }
+}
+
+void
+FluidNetwork::Recompute (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_recomputations++;
+  for (uint32_t l = 0; l < m_links.size (); l++)
+    {
+      m_links.at (l).remaining = m_links.at (l).capacity;
+      m_links.at (l).unfixed = 0;
+    }
+  m_order.clear ();
+  for (uint32_t p = 0; p < m_paths.size (); p++)
+    {
+      Path &path = m_paths.at (p);
+      path.fixed = false;
+      path.rate = 0;
+      if (path.ends.empty ())
+        {
+          continue;
+        }
+      for (uint32_t l = 0; l < path.links.size (); l++)
+        {
+          m_links.at (path.links.at (l)).unfixed += path.ends.size ();
+        }
+      m_order.push_back (p);
+    }
+  // paths limited by their maximum rate are fixed in the order of that rate
+  std::sort (m_order.begin (), m_order.end (), MaxRateOrder (this));
+
+  // progressive filling: the link offering the smallest equal share per flow fixes the shares of all paths
+  // crossing it, unless the maximum rate of a path is smaller still
+  uint32_t fixedPaths = 0;
+  uint32_t next = 0;
+  while (fixedPaths < m_order.size ())
+    {
+      double linkShare = std::numeric_limits<double>::infinity ();
+      int64_t bottleneck = -1;
+      for (uint32_t l = 0; l < m_links.size (); l++)
+        {
+          if (m_links.at (l).unfixed > 0 && m_links.at (l).remaining / m_links.at (l).unfixed < linkShare)
+            {
+              linkShare = m_links.at (l).remaining / m_links.at (l).unfixed;
+              bottleneck = l;
+            }
+        }
+      while (m_paths.at (m_order.at (next)).fixed)
+        {
+          next++;
+        }
+      Path &capped = m_paths.at (m_order.at (next));
+      if (capped.maxRate <= linkShare)
+        {
+          Fix (capped, capped.maxRate);
+          fixedPaths++;
+          continue;
+        }
+      for (uint32_t i = next; i < m_order.size (); i++)
+        {
+          Path &path = m_paths.at (m_order.at (i));
+          if (!path.fixed && std::find (path.links.begin (), path.links.end (), (uint32_t) bottleneck) != path.links.end ())
+            {
+              Fix (path, std::max (linkShare, 0.0));
+              fixedPaths++;
+            }
+        }
+    }
+}
+
+void
+FluidNetwork::Fix (Path &path, double rate)
+{
+  path.rate = rate;
+  path.fixed = true;
+  for (uint32_t l = 0; l < path.links.size (); l++)
+    {
+      m_links.at (path.links.at (l)).remaining -= rate * path.ends.size ();
+      m_links.at (path.links.at (l)).unfixed -= path.ends.size ();
+    }
+}
+
+void
+FluidNetwork::ScheduleCompletion (void)
+{
+  Simulator::Cancel (m_completion);
+  double first = std::numeric_limits<double>::infinity ();
+  for (uint32_t i = 0; i < m_order.size (); i++)
+    {
+      const Path &path = m_paths.at (m_order.at (i));
+      if (path.rate > 0)
+        {
+          first = std::min (first, std::max (path.ends.top ().service - path.service, 0.0) / path.rate);
+        }
+    }
+  if (first < std::numeric_limits<double>::infinity ())
+    {
+      m_completion = Simulator::Schedule (NanoSeconds ((int64_t) ceil (first * 1e9)), &FluidNetwork::Complete, this);
+    }
+}
+
+void
+FluidNetwork::Complete (void)
+{
+  NS_LOG_FUNCTION (this);
+  Advance ();
+  // flows finishing within the resolution of the simulator are complete
+  std::vector<Callback<void> > finished;
+  for (uint32_t i = 0; i < m_order.size (); i++)
+    {
+      Path &path = m_paths.at (m_order.at (i));
+      while (!path.ends.empty () && path.ends.top ().service - path.service <= path.rate * 1e-9 + 1e-6)
+        {
+          finished.push_back (path.ends.top ().finished);
+          path.ends.pop ();
+          m_activeFlows--;
+        }
+    }
+  Recompute ();
+  ScheduleCompletion ();
+  // the callbacks may start new flows, the network is consistent again already
+  for (uint32_t i = 0; i < finished.size (); i++)
+    {
+      finished.at (i) ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLUID_NETWORK_H
+#define FLUID_NETWORK_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include <stdint.h>
+#include <vector>
+#include <queue>
+#include <functional>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Flow-level network model, in which every download gets a max-min fair share of its bottlenecks.
+ *
+ * The network is a set of links with a capacity and a set of paths, each crossing some of the links, with a
+ * round trip time and a maximum rate, e.g. that of the access link of the clients using the path. A download
+ * is a flow of a number of bytes along a path. Its first byte arrives one round trip time after it was started,
+ * from then on it is transferred at its max-min fair share of the capacity of the links it crosses, limited
+ * to the maximum rate of its path. TCP dynamics like slow start and losses are not modelled.
+ *
+ * All flows of a path cross the same links with the same maximum rate, so they get the same share. The
+ * shares are therefore kept per path and recomputed whenever a flow becomes active or completes, at a cost
+ * depending on the number of paths and links only. Every path counts the bits each of its flows received so
+ * far and keeps its flows ordered by the count at which they are complete, and only the earliest completion
+ * is scheduled as an event. A start or completion thus costs O(paths * links + log(flows)), and the cost of
+ * the model grows with the number of downloads rather than the number of packets, as long as the clients
+ * share a few paths.
+ *
+ * TcpStreamClients download their segments as flows of a fluid network instead of over a socket, see
+ * TcpStreamClient::SetFluidNetwork.
+ */
+class FluidNetwork : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  FluidNetwork ();
+  virtual ~FluidNetwork ();
+
+  /**
+   * \brief Add a link shared by the flows of all paths crossing it.
+   *
+   * \param capacity the capacity of the link
+   * \return the index of the link
+   */
+  uint32_t AddLink (DataRate capacity);
+
+  /**
+   * \brief Add a path flows can be started along.
+   *
+   * \param links the indices of the links the path crosses
+   * \param rtt the time from starting a flow until its first byte arrives
+   * \param maxRate the maximum rate of a single flow on the path, 0 for no limit besides the links
+   * \return the index of the path
+   */
+  uint32_t AddPath (std::vector<uint32_t> links, Time rtt, DataRate maxRate);
+
+  /**
+   * \brief Start a download along a path.
+   *
+   * \param path the index of the path
+   * \param bytes the size of the download
+   * \param started called when the first byte arrives
+   * \param finished called when the last byte arrives
+   */
+  void StartFlow (uint32_t path, uint64_t bytes, Callback<void> started, Callback<void> finished);
+
+  /**
+   * \return the number of flows currently transferring data
+   */
+  uint32_t GetActiveFlows (void) const;
+
+  /**
+   * \return the highest number of flows transferring data at the same time so far
+   */
+  uint32_t GetPeakActiveFlows (void) const;
+
+  /**
+   * \return the number of times the shares of the flows were recomputed so far
+   */
+  uint64_t GetRecomputations (void) const;
+
+private:
+  /**
+   * \brief A link and its state during the computation of the shares.
+   */
+  struct Link
+  {
+    double capacity; //!< Capacity in bits per second
+    double remaining; //!< Capacity not given to fixed paths yet
+    uint32_t unfixed; //!< Number of flows crossing the link whose share is not fixed yet
+  };
+
+  /**
+   * \brief The completion of a flow, at the number of bits every flow of its path received so far.
+   */
+  struct FlowEnd
+  {
+    double service; //!< Service of the path at which the flow is complete
+    uint64_t id; //!< Order in which the flows became active, to complete simultaneous flows in that order
+    Callback<void> finished; //!< Called when the last byte arrived
+    bool operator> (const FlowEnd &other) const
+    {
+      return service > other.service || (service == other.service && id > other.id);
+    }
+  };
+
+  /**
+   * \brief A path flows are started along, with the flows transferring data on it.
+   */
+  struct Path
+  {
+    std::vector<uint32_t> links; //!< Indices of the links the path crosses
+    Time rtt; //!< Time from starting a flow until its first byte arrives
+    double maxRate; //!< Maximum rate of a flow in bits per second
+    double rate; //!< Current share of every flow of the path in bits per second
+    double service; //!< Bits every flow of the path received since the path was added
+    bool fixed; //!< True once the share is fixed during the computation of the shares
+    std::priority_queue<FlowEnd, std::vector<FlowEnd>, std::greater<FlowEnd> > ends; //!< The flows of the path, completing first on top
+  };
+
+  /**
+   * \brief Orders path indices by the maximum rate of the paths.
+   */
+  struct MaxRateOrder
+  {
+    MaxRateOrder (const FluidNetwork *network) : m_network (network) {}
+    bool operator() (uint32_t a, uint32_t b) const
+    {
+      return m_network->m_paths.at (a).maxRate < m_network->m_paths.at (b).maxRate;
+    }
+    const FluidNetwork *m_network; //!< The network the paths belong to
+  };
+
+  /**
+   * \brief The first byte of a flow arrived, from now on it shares the links of its path.
+   */
+  void ActivateFlow (uint32_t path, double bits, Callback<void> started, Callback<void> finished);
+
+  /**
+   * \brief Add the bits every flow received since the last update to the service of its path.
+   */
+  void Advance (void);
+
+  /**
+   * \brief Compute the max-min fair share of the flows of every path by progressive filling.
+   */
+  void Recompute (void);
+
+  /**
+   * \brief Fix the share of the flows of a path and take it from the links the path crosses.
+   */
+  void Fix (Path &path, double rate);
+
+  /**
+   * \brief Schedule the completion of the flow finishing first.
+   */
+  void ScheduleCompletion (void);
+
+  /**
+   * \brief Complete the flows that transferred all their bits.
+   */
+  void Complete (void);
+
+  std::vector<Link> m_links; //!< The links of the network
+  std::vector<Path> m_paths; //!< The paths of the network
+  std::vector<uint32_t> m_order; //!< Indices of the paths with active flows, sorted by their maximum rate
+  uint32_t m_activeFlows; //!< Number of flows transferring data
+  uint64_t m_nextFlowId; //!< Id of the next flow becoming active
+  Time m_lastUpdate; //!< Point in time the service of the paths was last updated
+  EventId m_completion; //!< The completion of the flow finishing first
+  uint32_t m_peakActiveFlows; //!< Highest number of flows transferring data at the same time
+  uint64_t m_recomputations; //!< Number of times the shares were recomputed
+};
+
+} // namespace ns3
+
+#endif /* FLUID_NETWORK_H */
@@ -0,0 +1,304 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mpc.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MpcAlgorithm");
+
+NS_OBJECT_ENSURE_REGISTERED (MpcAlgorithm);
+NS_ADAPTATION_ALGORITHM_REGISTER (MpcAlgorithm, "mpc");
+static AdaptationAlgorithmRegistrar<MpcAlgorithm> g_robustMpcRegistrar ("robust-mpc", "Robust=true");
+static AdaptationAlgorithmRegistrar<MpcAlgorithm> g_fastMpcRegistrar ("fast-mpc", "Fast=true");
+
+TypeId
+MpcAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpcAlgorithm")
+    .SetParent<AdaptationAlgorithm> ()
+    .SetGroupName ("Applications")
+    .AddAttribute ("Horizon",
+                   "The number of segments planned ahead",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&MpcAlgorithm::m_horizon),
+                   MakeUintegerChecker<uint32_t> (1, 10))
+    .AddAttribute ("SwitchPenalty",
+                   "The weight of quality changes in the QoE",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&MpcAlgorithm::m_switchPenalty),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("RebufferPenalty",
+                   "The weight of a second of rebuffering in the QoE, 0 uses the highest bitrate in Mbps",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MpcAlgorithm::m_rebufferPenalty),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Robust",
+                   "If true, the throughput estimate is reduced by the largest recent prediction error (RobustMPC)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MpcAlgorithm::m_robust),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Fast",
+                   "If true, decisions are looked up in a table precomputed once per manifest (FastMPC)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MpcAlgorithm::m_fast),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxBuffer",
+                   "The buffer level above which the next download is delayed, also the buffer range of the FastMPC table",
+                   TimeValue (Seconds (30)),
+                   MakeTimeAccessor (&MpcAlgorithm::m_maxBuffer),
+                   MakeTimeChecker ())
+    .AddAttribute ("BufferBins",
+                   "The number of buffer levels of the FastMPC table",
+                   UintegerValue (50),
+                   MakeUintegerAccessor (&MpcAlgorithm::m_bufferBins),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ThroughputBins",
+                   "The number of throughput estimates of the FastMPC table, spaced logarithmically",
+                   UintegerValue (50),
+                   MakeUintegerAccessor (&MpcAlgorithm::m_throughputBins),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+MpcAlgorithm::MpcAlgorithm (  const videoData &videoData,
+                              const playbackData & playbackData,
+                              const bufferData & bufferData,
+                              const throughputData & throughput) :
+  AdaptationAlgorithm (videoData, playbackData, bufferData, throughput),
+  m_horizon (5),
+  m_switchPenalty (1.0),
+  m_rebufferPenalty (0.0),
+  m_robust (false),
+  m_fast (false),
+  m_maxBuffer (Seconds (30)),
+  m_bufferBins (50),
+  m_throughputBins (50),
+  m_highestRepIndex (videoData.averageBitrate.size () - 1),
+  m_table (NULL),
+  m_minThroughput (0.0),
+  m_maxThroughput (0.0)
+{
+  NS_LOG_INFO (this);
+  NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be => 0");
+  for (int64_t i = 0; i <= m_highestRepIndex; i++)
+    {
+      m_quality.push_back (m_videoData.averageBitrate.at (i) / 1000000.0);
+    }
+}
+
+algorithmReply
+MpcAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
+{
+  int64_t timeNow = Now ();
+  algorithmReply answer;
+  answer.decisionTime = timeNow;
+  answer.nextDownloadDelay = 0;
+  answer.delayDecisionCase = 0;
+
+  if (segmentCounter == 0 || m_throughput.transmissionEnd.empty ())
+    {
+      answer.nextRepIndex = 0;
+      answer.decisionCase = 0;
+      return answer;
+    }
+  int64_t bufferNow = std::max ((int64_t) 0, m_bufferData.bufferLevelNew.back () - (timeNow - m_throughput.transmissionEnd.back ()));
+  double throughputEstimate = EstimateThroughput ();
+  int64_t lastRepIndex = m_playbackData.playbackIndex.back ();
+
+  if (m_fast)
+    {
+      PrepareTable ();
+      uint32_t bufferBin = std::min (m_bufferBins - 1, (uint32_t)(bufferNow * m_bufferBins / m_maxBuffer.GetMicroSeconds ()));
+      double position = log (throughputEstimate / m_minThroughput) / log (m_maxThroughput / m_minThroughput);
+      uint32_t throughputBin = (uint32_t) std::max (0.0, std::min ((double) m_throughputBins - 1, floor (position * m_throughputBins)));
+      answer.nextRepIndex = m_table->at ((lastRepIndex * m_bufferBins + bufferBin) * m_throughputBins + throughputBin);
+      answer.decisionCase = 2;
+    }
+  else
+    {
+      answer.nextRepIndex = Optimise (bufferNow / 1000000.0, throughputEstimate, lastRepIndex,
+                                      m_playbackData.firstSegmentIndex + segmentCounter);
+      answer.decisionCase = 1;
+    }
+
+  if (bufferNow > m_maxBuffer.GetMicroSeconds ())
+    {
+      answer.nextDownloadDelay = bufferNow - m_maxBuffer.GetMicroSeconds ();
+      answer.delayDecisionCase = 1;
+    }
+  return answer;
+}
+
+double
+MpcAlgorithm::EstimateThroughput ()
+{
+  uint32_t downloaded = m_throughput.transmissionEnd.size ();
+  double harmonicMeanDenominator = 0;
+  uint32_t samples = 0;
+  double maxError = 0;
+  for (uint32_t sd = downloaded; sd-- > 0 && samples < 5; )
+    {
+      double transmissionTime = (m_throughput.transmissionEnd.at (sd) - m_throughput.transmissionRequested.at (sd) - m_throughput.transmissionIdle.at (sd)) / 1000000.0;
+      if (m_throughput.bytesReceived.at (sd) == 0 || transmissionTime <= 0)
+        {
+          continue;
+        }
+      double throughput = (8.0 * m_throughput.bytesReceived.at (sd)) / transmissionTime;
+      harmonicMeanDenominator += 1 / throughput;
+      samples++;
+      if (sd < m_estimates.size () && m_estimates.at (sd) > 0)
+        {
+          maxError = std::max (maxError, std::abs (m_estimates.at (sd) - throughput) / throughput);
+        }
+    }
+  double estimate = samples > 0 ? samples / harmonicMeanDenominator : m_videoData.averageBitrate.at (0);
+  if (m_robust)
+    {
+      estimate = estimate / (1.0 + maxError);
+    }
+  // the estimate predicts the download of the next segment, 0 marks segments decided without one
+  m_estimates.resize (downloaded, 0.0);
+  m_estimates.push_back (estimate);
+  return estimate;
+}
+
+int64_t
+MpcAlgorithm::Optimise (double buffer, double throughput, int64_t lastRepIndex, int64_t segmentIndex)
+{
+  m_throughputEstimate = throughput;
+  m_segmentIndex = segmentIndex;
+  m_steps = m_horizon;
+  if (segmentIndex >= 0)
+    {
+      int64_t remaining = (int64_t) m_videoData.segmentSize.at (0).size () - segmentIndex;
+      m_steps = (uint32_t) std::max ((int64_t) 1, std::min ((int64_t) m_horizon, remaining));
+    }
+  m_bestRepIndex = 0;
+  m_bestQoe = -std::numeric_limits<double>::infinity ();
+  Search (0, lastRepIndex, buffer, 0.0);
+  return m_bestRepIndex;
+}
+
+void
+MpcAlgorithm::Search (uint32_t step, int64_t lastRepIndex, double buffer, double qoe)
+{
+  if (step == m_steps)
+    {
+      if (qoe > m_bestQoe)
+        {
+          m_bestQoe = qoe;
+          m_bestRepIndex = m_firstRepIndex;
+        }
+      return;
+    }
+  // even the highest quality without any penalty for the remaining segments can not beat the best sequence
+  if (qoe + (m_steps - step) * m_quality.back () <= m_bestQoe)
+    {
+      return;
+    }
+  double segmentDuration = m_videoData.segmentDuration / 1000000.0;
+  double rebufferPenalty = m_rebufferPenalty > 0 ? m_rebufferPenalty : m_quality.back ();
+  // start with the highest representation, good sequences found early prune more
+  for (int64_t i = m_highestRepIndex; i >= 0; i--)
+    {
+      double bits = m_segmentIndex < 0 ? m_videoData.averageBitrate.at (i) * segmentDuration
+        : 8.0 * m_videoData.segmentSize.at (i).at (m_segmentIndex + step);
+      double downloadTime = bits / m_throughputEstimate;
+      double rebuffer = std::max (0.0, downloadTime - buffer);
+      double value = qoe + m_quality.at (i)
+        - m_switchPenalty * std::abs (m_quality.at (i) - m_quality.at (lastRepIndex))
+        - rebufferPenalty * rebuffer;
+      if (step == 0)
+        {
+          m_firstRepIndex = i;
+        }
+      Search (step + 1, i, std::max (buffer - downloadTime, 0.0) + segmentDuration, value);
+    }
+}
+
+void
+MpcAlgorithm::PrepareTable ()
+{
+  if (m_table != NULL)
+    {
+      return;
+    }
+  NS_ABORT_MSG_IF (m_highestRepIndex >= 256, "FastMPC stores decisions in one byte, at most 256 representations are supported");
+  m_minThroughput = m_videoData.averageBitrate.front () / 4.0;
+  m_maxThroughput = m_videoData.averageBitrate.back () * 4.0;
+
+  // the table depends on the manifest and the parameters only, so clients of the same video share it
+  static std::map<std::string, std::vector<uint8_t> > tables;
+  std::ostringstream key;
+  key << m_videoData.segmentDuration << " " << m_horizon << " " << m_switchPenalty << " " << m_rebufferPenalty << " "
+      << m_maxBuffer.GetMicroSeconds () << " " << m_bufferBins << " " << m_throughputBins;
+  for (uint32_t i = 0; i < m_videoData.averageBitrate.size (); i++)
+    {
+      key << " " << m_videoData.averageBitrate.at (i);
+    }
+  std::map<std::string, std::vector<uint8_t> >::iterator it = tables.find (key.str ());
+  if (it != tables.end ())
+    {
+      m_table = &it->second;
+      return;
+    }
+
+  std::clock_t buildStart = std::clock ();
+  std::vector<uint8_t> & table = tables[key.str ()];
+  table.resize ((m_highestRepIndex + 1) * m_bufferBins * m_throughputBins);
+  double bufferStep = m_maxBuffer.GetSeconds () / m_bufferBins;
+  double throughputStep = log (m_maxThroughput / m_minThroughput) / m_throughputBins;
+  for (int64_t lastRepIndex = 0; lastRepIndex <= m_highestRepIndex; lastRepIndex++)
+    {
+      for (uint32_t b = 0; b < m_bufferBins; b++)
+        {
+          for (uint32_t c = 0; c < m_throughputBins; c++)
+            {
+              double throughput = m_minThroughput * exp ((c + 0.5) * throughputStep);
+              table.at ((lastRepIndex * m_bufferBins + b) * m_throughputBins + c) =
+                (uint8_t) Optimise ((b + 0.5) * bufferStep, throughput, lastRepIndex, -1);
+            }
+        }
+    }
+  double buildTime = 1000.0 * (std::clock () - buildStart) / CLOCKS_PER_SEC;
+  m_table = &table;
+
+  NS_LOG_INFO ("FastMPC table with " << table.size () << " entries built in " << buildTime << " ms");
+  std::ofstream tableLog ((dashLogDirectory + "fastMpcTableLog.txt").c_str (), std::ios::app);
+  if (tableLog.tellp () == 0)
+    {
+      tableLog << "Representations Horizon Entries Bytes Build_Time_ms\n";
+    }
+  tableLog << std::setfill (' ') << std::setw (15) << m_highestRepIndex + 1 << " "
+           << std::setfill (' ') << std::setw (7) << m_horizon << " "
+           << std::setfill (' ') << std::setw (7) << table.size () << " "
+           << std::setfill (' ') << std::setw (5) << table.size () * sizeof (uint8_t) << " "
+           << std::setfill (' ') << std::setw (13) << buildTime << "\n";
+}
+
+} // namespace ns3
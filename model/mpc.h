@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPC_ALGORITHM_H
+#define MPC_ALGORITHM_H
+
+#include "tcp-stream-adaptation-algorithm.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Implementation of the MPC, RobustMPC and FastMPC adaptation algorithms
+ *
+ * Model predictive control (Yin et al., "A Control-Theoretic Approach for Dynamic Adaptive Video Streaming
+ * over HTTP") chooses the first representation of the sequence over the next Horizon segments that maximises
+ *
+ *   sum q (r_k) - SwitchPenalty * sum |q (r_k) - q (r_k-1)| - RebufferPenalty * sum rebuffering time,
+ *
+ * with q the bitrate in Mbps, predicting the download times from the segment sizes and a harmonic mean
+ * throughput estimate. The sequences are searched depth first, pruning branches that can not beat the best one.
+ * RobustMPC divides the estimate by one plus the largest recent prediction error.
+ *
+ * FastMPC looks the decision up in a table indexed by quantised buffer level, throughput estimate and last
+ * representation instead. The table is computed once per manifest and parameter set from the average segment
+ * sizes and shared by all clients of the simulation; its build time and size are appended to
+ * dashLogDirectory/fastMpcTableLog.txt.
+ */
+class MpcAlgorithm : public AdaptationAlgorithm
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MpcAlgorithm (  const videoData &videoData,
+                  const playbackData & playbackData,
+                  const bufferData & bufferData,
+                  const throughputData & throughput);
+
+  algorithmReply GetNextRep (const int64_t segmentCounter, int64_t clientId);
+
+private:
+  /**
+   * \brief Harmonic mean of the throughput of the last segments, reduced by the largest recent prediction error if robust.
+   * \return the throughput estimate in bits per second
+   */
+  double EstimateThroughput ();
+  /**
+   * \brief Find the first representation of the sequence maximising the QoE over the horizon.
+   *
+   * \param buffer the buffer level in seconds
+   * \param throughput the throughput estimate in bits per second
+   * \param lastRepIndex the representation of the last segment
+   * \param segmentIndex the index in the video of the next segment, -1 to plan with the average segment sizes
+   * \return the representation index
+   */
+  int64_t Optimise (double buffer, double throughput, int64_t lastRepIndex, int64_t segmentIndex);
+  /**
+   * \brief Depth first search over the representation sequences, see Optimise.
+   *
+   * \param step the number of segments planned so far
+   * \param lastRepIndex the representation of the segment planned last
+   * \param buffer the predicted buffer level in seconds
+   * \param qoe the QoE of the sequence planned so far
+   */
+  void Search (uint32_t step, int64_t lastRepIndex, double buffer, double qoe);
+  /**
+   * \brief Get the decision table for this manifest and parameter set, building it if no client did so yet.
+   */
+  void PrepareTable ();
+
+  uint32_t m_horizon; //!< The number of segments planned ahead
+  double m_switchPenalty; //!< The weight of quality changes
+  double m_rebufferPenalty; //!< The weight of a second of rebuffering, 0 uses the highest bitrate in Mbps
+  bool m_robust; //!< True for RobustMPC
+  bool m_fast; //!< True for FastMPC
+  Time m_maxBuffer; //!< The buffer level above which the next download is delayed, also the range of the table
+  uint32_t m_bufferBins; //!< The number of buffer levels of the table
+  uint32_t m_throughputBins; //!< The number of throughput estimates of the table
+  const int64_t m_highestRepIndex;
+  std::vector<double> m_quality; //!< The quality of every representation, its bitrate in Mbps
+  std::vector<double> m_estimates; //!< The throughput estimates of the segments downloaded so far, to compute the prediction error
+  const std::vector<uint8_t> * m_table; //!< The FastMPC decisions, shared by all clients streaming the same manifest
+  double m_minThroughput; //!< The lowest throughput estimate of the table in bits per second
+  double m_maxThroughput; //!< The highest throughput estimate of the table in bits per second
+
+  // state of the running search
+  double m_throughputEstimate; //!< The throughput estimate the search predicts download times with
+  int64_t m_segmentIndex; //!< The index in the video of the first planned segment, -1 for average segment sizes
+  uint32_t m_steps; //!< The number of segments to plan, less than the horizon at the end of the video
+  int64_t m_firstRepIndex; //!< The first representation of the sequence being searched
+  int64_t m_bestRepIndex; //!< The first representation of the best sequence so far
+  double m_bestQoe; //!< The QoE of the best sequence so far
+};
+
+} // namespace ns3
+#endif /* MPC_ALGORITHM_H */
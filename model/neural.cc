@@ -0,0 +1,291 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "neural.h"
+#include "ns3/string.h"
+#include "ns3/fatal-error.h"
+#include <map>
+#include <iomanip>
+#include <time.h>
+#ifdef __AVX__
+#include <immintrin.h>
+#elif defined (__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NeuralAlgorithm");
+
+NS_OBJECT_ENSURE_REGISTERED (NeuralAlgorithm);
+NS_ADAPTATION_ALGORITHM_REGISTER (NeuralAlgorithm, "neural");
+
+/// The number of past segments in the observation
+static const uint32_t g_history = 8;
+
+TypeId
+NeuralAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NeuralAlgorithm")
+    .SetParent<AdaptationAlgorithm> ()
+    .SetGroupName ("Applications")
+    .AddAttribute ("WeightsFile",
+                   "The binary file holding the layers of the network",
+                   StringValue (""),
+                   MakeStringAccessor (&NeuralAlgorithm::m_weightsFile),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+NeuralAlgorithm::NeuralAlgorithm (  const videoData &videoData,
+                                    const playbackData & playbackData,
+                                    const bufferData & bufferData,
+                                    const throughputData & throughput) :
+  AdaptationAlgorithm (videoData, playbackData, bufferData, throughput),
+  m_highestRepIndex (videoData.averageBitrate.size () - 1),
+  m_layers (NULL),
+  m_decisions (0),
+  m_inferenceTime (0.0),
+  m_maxInferenceTime (0.0),
+  m_clientId (-1)
+{
+  NS_LOG_INFO (this);
+  NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be => 0");
+}
+
+NeuralAlgorithm::~NeuralAlgorithm ()
+{
+  if (m_decisions == 0)
+    {
+      return;
+    }
+  std::ofstream inferenceLog ((dashLogDirectory + "neuralInferenceLog.txt").c_str (), std::ios::app);
+  if (inferenceLog.tellp () == 0)
+    {
+      inferenceLog << "Client Decisions Mean_Inference_us Max_Inference_us\n";
+    }
+  inferenceLog << std::setfill (' ') << std::setw (6) << m_clientId << " "
+               << std::setfill (' ') << std::setw (9) << m_decisions << " "
+               << std::setfill (' ') << std::setw (17) << m_inferenceTime / m_decisions << " "
+               << std::setfill (' ') << std::setw (16) << m_maxInferenceTime << "\n";
+}
+
+void
+NeuralAlgorithm::NotifyConstructionCompleted (void)
+{
+  m_layers = LoadWeights (m_weightsFile);
+  uint32_t representations = m_highestRepIndex + 1;
+  NS_ABORT_MSG_IF (m_layers->front ().inputs != 2 * g_history + 3 + representations,
+                   "The network in " << m_weightsFile << " does not read " << 2 * g_history + 3 + representations << " inputs");
+  NS_ABORT_MSG_IF (m_layers->back ().outputs != representations,
+                   "The network in " << m_weightsFile << " does not have one output per representation");
+  uint32_t width = 0;
+  for (uint32_t i = 0; i < m_layers->size (); i++)
+    {
+      width = std::max (width, std::max (m_layers->at (i).stride, m_layers->at (i).outputs));
+    }
+  // zeros beyond the inputs of a layer stay zero, as only the outputs are ever written
+  m_observation.assign (m_layers->front ().stride, 0.0f);
+  m_activations[0].assign (width, 0.0f);
+  m_activations[1].assign (width, 0.0f);
+  AdaptationAlgorithm::NotifyConstructionCompleted ();
+}
+
+const std::vector<NeuralAlgorithm::Layer> *
+NeuralAlgorithm::LoadWeights (std::string path)
+{
+  static std::map<std::string, std::vector<Layer> > networks;
+  std::map<std::string, std::vector<Layer> >::iterator it = networks.find (path);
+  if (it != networks.end ())
+    {
+      return &it->second;
+    }
+  std::ifstream file (path.c_str (), std::ios::binary);
+  if (!file)
+    {
+      NS_FATAL_ERROR ("Opening the weights file " << path << " failed");
+    }
+  uint32_t numberOfLayers = 0;
+  file.read ((char *) &numberOfLayers, sizeof (uint32_t));
+  std::vector<Layer> layers (numberOfLayers);
+  for (uint32_t l = 0; l < numberOfLayers && file; l++)
+    {
+      Layer & layer = layers.at (l);
+      file.read ((char *) &layer.inputs, sizeof (uint32_t));
+      file.read ((char *) &layer.outputs, sizeof (uint32_t));
+      layer.stride = (layer.inputs + 7) / 8 * 8;
+      layer.weights.assign ((size_t) layer.outputs * layer.stride, 0.0f);
+      for (uint32_t o = 0; o < layer.outputs && file; o++)
+        {
+          file.read ((char *) &layer.weights.at ((size_t) o * layer.stride), layer.inputs * sizeof (float));
+        }
+      layer.bias.assign (layer.outputs, 0.0f);
+      file.read ((char *) &layer.bias.front (), layer.outputs * sizeof (float));
+      if (l > 0 && layers.at (l - 1).outputs != layer.inputs)
+        {
+          NS_FATAL_ERROR ("Layer " << l << " in " << path << " does not read the outputs of the previous layer");
+        }
+    }
+  if (!file || numberOfLayers == 0)
+    {
+      NS_FATAL_ERROR ("The weights file " << path << " is truncated or empty");
+    }
+  NS_LOG_INFO ("Loaded " << numberOfLayers << " layers from " << path);
+  return &(networks[path] = layers);
+}
+
+void
+NeuralAlgorithm::Dense (const Layer & layer, const float * in, float * out, bool relu)
+{
+  uint32_t o = 0;
+  for (; o + 4 <= layer.outputs; o += 4)
+    {
+      const float * w0 = &layer.weights[(size_t) o * layer.stride];
+      const float * w1 = w0 + layer.stride;
+      const float * w2 = w1 + layer.stride;
+      const float * w3 = w2 + layer.stride;
+      float sum [4];
+#ifdef __AVX__
+      __m256 s0 = _mm256_setzero_ps (), s1 = _mm256_setzero_ps (), s2 = _mm256_setzero_ps (), s3 = _mm256_setzero_ps ();
+      for (uint32_t i = 0; i < layer.stride; i += 8)
+        {
+          __m256 x = _mm256_loadu_ps (in + i);
+          s0 = _mm256_add_ps (s0, _mm256_mul_ps (_mm256_loadu_ps (w0 + i), x));
+          s1 = _mm256_add_ps (s1, _mm256_mul_ps (_mm256_loadu_ps (w1 + i), x));
+          s2 = _mm256_add_ps (s2, _mm256_mul_ps (_mm256_loadu_ps (w2 + i), x));
+          s3 = _mm256_add_ps (s3, _mm256_mul_ps (_mm256_loadu_ps (w3 + i), x));
+        }
+      // transpose-add the four accumulators, so sum [k] is the horizontal sum of sk
+      __m256 s01 = _mm256_hadd_ps (s0, s1);
+      __m256 s23 = _mm256_hadd_ps (s2, s3);
+      __m256 s0123 = _mm256_hadd_ps (s01, s23);
+      _mm_storeu_ps (sum, _mm_add_ps (_mm256_castps256_ps128 (s0123), _mm256_extractf128_ps (s0123, 1)));
+#elif defined (__SSE__)
+      __m128 s0 = _mm_setzero_ps (), s1 = _mm_setzero_ps (), s2 = _mm_setzero_ps (), s3 = _mm_setzero_ps ();
+      for (uint32_t i = 0; i < layer.stride; i += 4)
+        {
+          __m128 x = _mm_loadu_ps (in + i);
+          s0 = _mm_add_ps (s0, _mm_mul_ps (_mm_loadu_ps (w0 + i), x));
+          s1 = _mm_add_ps (s1, _mm_mul_ps (_mm_loadu_ps (w1 + i), x));
+          s2 = _mm_add_ps (s2, _mm_mul_ps (_mm_loadu_ps (w2 + i), x));
+          s3 = _mm_add_ps (s3, _mm_mul_ps (_mm_loadu_ps (w3 + i), x));
+        }
+      _MM_TRANSPOSE4_PS (s0, s1, s2, s3);
+      _mm_storeu_ps (sum, _mm_add_ps (_mm_add_ps (s0, s1), _mm_add_ps (s2, s3)));
+#else
+      sum[0] = sum[1] = sum[2] = sum[3] = 0.0f;
+      for (uint32_t i = 0; i < layer.stride; i++)
+        {
+          sum[0] += w0[i] * in[i];
+          sum[1] += w1[i] * in[i];
+          sum[2] += w2[i] * in[i];
+          sum[3] += w3[i] * in[i];
+        }
+#endif
+      for (uint32_t k = 0; k < 4; k++)
+        {
+          float value = sum[k] + layer.bias[o + k];
+          out[o + k] = relu && value < 0.0f ? 0.0f : value;
+        }
+    }
+  for (; o < layer.outputs; o++)
+    {
+      const float * w = &layer.weights[(size_t) o * layer.stride];
+      float value = layer.bias[o];
+      for (uint32_t i = 0; i < layer.inputs; i++)
+        {
+          value += w[i] * in[i];
+        }
+      out[o] = relu && value < 0.0f ? 0.0f : value;
+    }
+}
+
+void
+NeuralAlgorithm::Observe (int64_t segmentIndex)
+{
+  int64_t timeNow = Now ();
+  int64_t bufferNow = std::max ((int64_t) 0, m_bufferData.bufferLevelNew.back () - (timeNow - m_throughput.transmissionEnd.back ()));
+  float * observation = &m_observation.front ();
+  observation[0] = m_videoData.averageBitrate.at (m_playbackData.playbackIndex.back ()) / m_videoData.averageBitrate.back ();
+  observation[1] = bufferNow / 10000000.0;
+  uint32_t downloaded = m_throughput.transmissionEnd.size ();
+  for (uint32_t k = 0; k < g_history; k++)
+    {
+      observation[2 + k] = 0.0f;
+      observation[2 + g_history + k] = 0.0f;
+      if (downloaded + k < g_history)
+        {
+          continue;
+        }
+      uint32_t sd = downloaded + k - g_history;
+      double downloadTime = (m_throughput.transmissionEnd.at (sd) - m_throughput.transmissionRequested.at (sd) - m_throughput.transmissionIdle.at (sd)) / 1000000.0;
+      if (downloadTime > 0)
+        {
+          observation[2 + k] = 8.0 * m_throughput.bytesReceived.at (sd) / downloadTime / 10000000.0;
+          observation[2 + g_history + k] = downloadTime / 10.0;
+        }
+    }
+  int64_t numberOfSegments = m_videoData.segmentSize.at (0).size ();
+  int64_t nextIndex = std::min (segmentIndex, numberOfSegments - 1);
+  for (int64_t i = 0; i <= m_highestRepIndex; i++)
+    {
+      observation[2 + 2 * g_history + i] = m_videoData.segmentSize.at (i).at (nextIndex) / 1000000.0;
+    }
+  observation[3 + 2 * g_history + m_highestRepIndex] = (double)(numberOfSegments - segmentIndex) / numberOfSegments;
+}
+
+algorithmReply
+NeuralAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
+{
+  int64_t timeNow = Now ();
+  algorithmReply answer;
+  answer.decisionTime = timeNow;
+  answer.nextDownloadDelay = 0;
+  answer.delayDecisionCase = 0;
+  m_clientId = clientId;
+
+  if (segmentCounter == 0 || m_throughput.transmissionEnd.empty ())
+    {
+      answer.nextRepIndex = 0;
+      answer.decisionCase = 0;
+      return answer;
+    }
+
+  struct timespec inferenceStart, inferenceEnd;
+  clock_gettime (CLOCK_MONOTONIC, &inferenceStart);
+  Observe (m_playbackData.firstSegmentIndex + segmentCounter);
+  const float * in = &m_observation.front ();
+  for (uint32_t l = 0; l < m_layers->size (); l++)
+    {
+      float * out = &m_activations[l % 2].front ();
+      Dense (m_layers->at (l), in, out, l + 1 < m_layers->size ());
+      in = out;
+    }
+  answer.nextRepIndex = std::max_element (in, in + m_highestRepIndex + 1) - in;
+  clock_gettime (CLOCK_MONOTONIC, &inferenceEnd);
+
+  double inferenceTime = (inferenceEnd.tv_sec - inferenceStart.tv_sec) * 1000000.0 + (inferenceEnd.tv_nsec - inferenceStart.tv_nsec) / 1000.0;
+  m_decisions++;
+  m_inferenceTime += inferenceTime;
+  m_maxInferenceTime = std::max (m_maxInferenceTime, inferenceTime);
+  answer.decisionCase = 1;
+  return answer;
+}
+
+} // namespace ns3
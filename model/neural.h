@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NEURAL_ALGORITHM_H
+#define NEURAL_ALGORITHM_H
+
+#include "tcp-stream-adaptation-algorithm.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief An adaptation algorithm running a learned policy, a small fully connected network (e.g. Pensieve-style)
+ *
+ * The network reads an observation of 19 + R values, R being the number of representations:
+ * - 0: bitrate of the last representation divided by the highest bitrate
+ * - 1: buffer level in units of 10 seconds
+ * - 2 to 9: throughput of the last 8 segments in units of 10 Mbps, oldest first, 0 if not downloaded yet
+ * - 10 to 17: download time of the last 8 segments in units of 10 seconds, oldest first
+ * - 18 to 17 + R: size of the next segment in every representation in MB
+ * - 18 + R: fraction of the segments of the video not downloaded yet
+ *
+ * All layers but the last apply ReLU; the representation with the largest output is chosen. The weights are
+ * read from WeightsFile, a binary file of little-endian values: uint32 number of layers, then per layer uint32
+ * inputs, uint32 outputs, float32 weights [outputs][inputs] and float32 bias [outputs]. Clients using the same
+ * file share the weights. The dense layers are computed with AVX or SSE if the compiler targets them.
+ *
+ * Every algorithm instance measures the wall-clock time of its inferences and appends count, mean and maximum
+ * to dashLogDirectory/neuralInferenceLog.txt when it is destroyed.
+ */
+class NeuralAlgorithm : public AdaptationAlgorithm
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  NeuralAlgorithm (  const videoData &videoData,
+                     const playbackData & playbackData,
+                     const bufferData & bufferData,
+                     const throughputData & throughput);
+
+  virtual ~NeuralAlgorithm ();
+
+  algorithmReply GetNextRep (const int64_t segmentCounter, int64_t clientId);
+
+  /**
+   * \brief A dense layer, rows padded with zeros to a multiple of eight floats.
+   */
+  struct Layer
+  {
+    uint32_t inputs; //!< The number of inputs
+    uint32_t outputs; //!< The number of outputs
+    uint32_t stride; //!< The number of floats per row of weights, inputs rounded up to a multiple of 8
+    std::vector<float> weights; //!< The weights, outputs rows of stride floats
+    std::vector<float> bias; //!< The bias of every output
+  };
+
+protected:
+  /**
+   * \brief Load the weights once the attributes are set.
+   */
+  virtual void NotifyConstructionCompleted (void);
+
+private:
+  /**
+   * \brief Read the network from a weights file, or get it from a client that read the same file already.
+   * \param path the path of the weights file
+   * \return the layers of the network
+   */
+  static const std::vector<Layer> * LoadWeights (std::string path);
+  /**
+   * \brief Compute out = W in + b for one layer, optionally applying ReLU.
+   *
+   * Four rows are computed at once, so every chunk of the input is loaded once per four rows.
+   * in must hold layer.stride floats, the ones beyond layer.inputs being finite.
+   *
+   * \param layer the layer
+   * \param in the input of the layer
+   * \param out the output of the layer, layer.outputs floats
+   * \param relu true if ReLU is applied
+   */
+  static void Dense (const Layer & layer, const float * in, float * out, bool relu);
+  /**
+   * \brief Fill m_observation for the next decision.
+   * \param segmentIndex the index in the video of the segment to decide on
+   */
+  void Observe (int64_t segmentIndex);
+
+  std::string m_weightsFile; //!< The path of the weights file
+  const int64_t m_highestRepIndex;
+  const std::vector<Layer> * m_layers; //!< The network, shared by all clients reading the same weights file
+  std::vector<float> m_observation; //!< The input of the network, padded to the stride of the first layer
+  std::vector<float> m_activations [2]; //!< The outputs of consecutive layers
+  uint64_t m_decisions; //!< The number of inferences run
+  double m_inferenceTime; //!< The total wall-clock time of the inferences in microseconds
+  double m_maxInferenceTime; //!< The longest inference in microseconds
+  int64_t m_clientId; //!< The client deciding, for the inference log
+};
+
+} // namespace ns3
+#endif /* NEURAL_ALGORITHM_H */
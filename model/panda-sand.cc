@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "panda-sand.h"
+#include "ns3/double.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PandaSandAlgorithm");
+
+NS_OBJECT_ENSURE_REGISTERED (PandaSandAlgorithm);
+NS_ADAPTATION_ALGORITHM_REGISTER (PandaSandAlgorithm, "panda-sand");
+
+TypeId
+PandaSandAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PandaSandAlgorithm")
+    .SetParent<PandaAlgorithm> ()
+    .SetGroupName ("Applications")
+    .AddAttribute ("Slack",
+                   "The relative deviation from the fair share announced by the server the bandwidth share estimate is kept within",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&PandaSandAlgorithm::m_slack),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+PandaSandAlgorithm::PandaSandAlgorithm (  const videoData &videoData,
+                                          const playbackData & playbackData,
+                                          const bufferData & bufferData,
+                                          const throughputData & throughput) :
+  PandaAlgorithm (videoData, playbackData, bufferData, throughput),
+  m_slack (0.1)
+{
+  NS_LOG_INFO (this);
+}
+
+double
+PandaSandAlgorithm::AdjustBandwidthShare (double bandwidthShare, double throughputMeasured)
+{
+  // only use hints that arrived with the last segment, older ones are outdated
+  if (m_serverHints == NULL
+      || m_serverHints->fairShare.empty ()
+      || m_serverHints->timeReceived.back () < m_throughput.transmissionRequested.back ())
+    {
+      return bandwidthShare;
+    }
+  double fairShare = m_serverHints->fairShare.back () / 1e6;
+  if (fairShare <= 0)
+    {
+      return bandwidthShare;
+    }
+  double upperBound = (1 + m_slack) * fairShare;
+  double lowerBound = std::min ((1 - m_slack) * fairShare, throughputMeasured);
+  return std::max (lowerBound, std::min (bandwidthShare, upperBound));
+}
+
+} // namespace ns3
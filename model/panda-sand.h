@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PANDA_SAND_ALGORITHM_H
+#define PANDA_SAND_ALGORITHM_H
+
+#include "panda.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Implementation of the Panda adaptation algorithm, assisted by the server's bandwidth hints
+ *
+ * Panda probes for its bandwidth share by additively increasing its estimate until congestion is
+ * detected, which makes clients sharing a bottleneck converge slowly and oscillate around their share.
+ * If the server piggybacks hints on its responses (see serverHints), this variant keeps the estimate within
+ * m_slack of the fair share announced by the server: it does not probe beyond it and jumps up to it right away,
+ * as long as the throughput measured for the last segment does not contradict the hint.
+ * Without hints it behaves exactly like Panda.
+ */
+class PandaSandAlgorithm : public PandaAlgorithm
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PandaSandAlgorithm (  const videoData &videoData,
+                        const playbackData & playbackData,
+                        const bufferData & bufferData,
+                        const throughputData & throughput);
+
+protected:
+  double AdjustBandwidthShare (double bandwidthShare, double throughputMeasured);
+
+private:
+  double m_slack;
+};
+
+} // namespace ns3
+#endif /* PANDA_SAND_ALGORITHM_H */
@@ -17,6 +17,8 @@
  */
 
 #include "panda.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
 
 
 namespace ns3 {
@@ -24,6 +26,47 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("PandaAlgorithm");
 
 NS_OBJECT_ENSURE_REGISTERED (PandaAlgorithm);
+NS_ADAPTATION_ALGORITHM_REGISTER (PandaAlgorithm, "panda");
+
+TypeId
+PandaAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PandaAlgorithm")
+    .SetParent<AdaptationAlgorithm> ()
+    .SetGroupName ("Applications")
+    .AddAttribute ("Kappa",
+                   "The probing convergence rate",
+                   DoubleValue (0.28),
+                   MakeDoubleAccessor (&PandaAlgorithm::m_kappa),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Omega",
+                   "The probing additive increase bitrate in Mbps",
+                   DoubleValue (0.3),
+                   MakeDoubleAccessor (&PandaAlgorithm::m_omega),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Alpha",
+                   "The smoothing convergence rate",
+                   DoubleValue (0.2),
+                   MakeDoubleAccessor (&PandaAlgorithm::m_alpha),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Beta",
+                   "The client buffer convergence rate",
+                   DoubleValue (0.2),
+                   MakeDoubleAccessor (&PandaAlgorithm::m_beta),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Epsilon",
+                   "The multiplicative safety margin of the quantizer when switching up",
+                   DoubleValue (0.15),
+                   MakeDoubleAccessor (&PandaAlgorithm::m_epsilon),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("BMin",
+                   "The minimum buffer level in seconds",
+                   IntegerValue (26),
+                   MakeIntegerAccessor (&PandaAlgorithm::m_bMin),
+                   MakeIntegerChecker<int64_t> (0))
+  ;
+  return tid;
+}
 
 PandaAlgorithm::PandaAlgorithm (  const videoData &videoData,
                                   const playbackData & playbackData,
@@ -45,7 +88,7 @@ PandaAlgorithm::PandaAlgorithm (  const videoData &videoData,
 algorithmReply
 PandaAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
 {
-  const int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  const int64_t timeNow = Now ();
   int64_t delay = 0;
   if (segmentCounter == 0)
     {
@@ -64,7 +107,7 @@ PandaAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
 
   // estimate the bandwidth share
   double throughputMeasured = ((double)(m_videoData.averageBitrate.at (m_lastVideoIndex) * (m_videoData.segmentDuration / 1e6) )
-                               / (double)((m_throughput.transmissionEnd.back () - m_throughput.transmissionRequested.back ()) / 1e6)) / 1e6;
+                               / (double)((m_throughput.transmissionEnd.back () - m_throughput.transmissionRequested.back () - m_throughput.transmissionIdle.back ()) / 1e6)) / 1e6;
 
   if (segmentCounter == 1)
     {
@@ -84,6 +127,7 @@ PandaAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
 
   double bandwidthShare = (m_kappa * (m_omega - std::max (0.0, m_lastBandwidthShare - throughputMeasured + m_omega)))
     * actualInterrequestTime + m_lastBandwidthShare;
+  bandwidthShare = AdjustBandwidthShare (bandwidthShare, throughputMeasured);
   if (bandwidthShare < 0)
     {
       bandwidthShare = 0;
@@ -150,6 +194,12 @@ PandaAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
   return answer;
 }
 
+double
+PandaAlgorithm::AdjustBandwidthShare (double bandwidthShare, double throughputMeasured)
+{
+  return bandwidthShare;
+}
+
 int
 PandaAlgorithm::FindLargest (const double smoothBandwidthShare, const int64_t segmentCounter, const double delta)
 {
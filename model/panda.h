@@ -30,6 +30,12 @@ namespace ns3 {
 class PandaAlgorithm : public AdaptationAlgorithm
 {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
   PandaAlgorithm (  const videoData &videoData,
                     const playbackData & playbackData,
                     const bufferData & bufferData,
@@ -37,14 +43,27 @@ public:
 
   algorithmReply GetNextRep (const int64_t segmentCounter, int64_t clientId);
 
+protected:
+  /**
+   * \brief Adjust the estimated bandwidth share before it is smoothed.
+   *
+   * Hook for variants of Panda which take further information into account when estimating
+   * the bandwidth share. Panda itself returns the estimate unchanged.
+   *
+   * \param bandwidthShare the bandwidth share estimated by probing, in Mbps
+   * \param throughputMeasured the throughput measured for the last segment, in Mbps
+   * \return the bandwidth share to continue with, in Mbps
+   */
+  virtual double AdjustBandwidthShare (double bandwidthShare, double throughputMeasured);
+
 private:
   int FindLargest (const double smoothBandwidthShare, const int64_t segmentCounter, const double delta);
-  const double m_kappa;
-  const double m_omega;
-  const double m_alpha;
-  const double m_beta;
-  const double m_epsilon;
-  const int64_t m_bMin;
+  double m_kappa;
+  double m_omega;
+  double m_alpha;
+  double m_beta;
+  double m_epsilon;
+  int64_t m_bMin;
   const int64_t m_highestRepIndex;
   int64_t m_lastBuffer;
   double m_lastTargetInterrequestTime;
@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "quality-aware.h"
+#include "ns3/double.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QualityAwareAlgorithm");
+
+NS_OBJECT_ENSURE_REGISTERED (QualityAwareAlgorithm);
+NS_ADAPTATION_ALGORITHM_REGISTER (QualityAwareAlgorithm, "quality-aware");
+
+TypeId
+QualityAwareAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QualityAwareAlgorithm")
+    .SetParent<AdaptationAlgorithm> ()
+    .SetGroupName ("Applications")
+    .AddAttribute ("MinBuffer",
+                   "The buffer level a download must not drain the buffer below",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&QualityAwareAlgorithm::m_minBuffer),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxBuffer",
+                   "The buffer level above which the next download is delayed",
+                   TimeValue (Seconds (30)),
+                   MakeTimeAccessor (&QualityAwareAlgorithm::m_maxBuffer),
+                   MakeTimeChecker ())
+    .AddAttribute ("QualityTolerance",
+                   "The quality difference to the best feasible representation that is considered imperceptible, in units of the quality metric",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&QualityAwareAlgorithm::m_qualityTolerance),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+QualityAwareAlgorithm::QualityAwareAlgorithm (  const videoData &videoData,
+                                                const playbackData & playbackData,
+                                                const bufferData & bufferData,
+                                                const throughputData & throughput) :
+  AdaptationAlgorithm (videoData, playbackData, bufferData, throughput),
+  m_minBuffer (Seconds (10)),
+  m_maxBuffer (Seconds (30)),
+  m_qualityTolerance (1.0),
+  m_highestRepIndex (videoData.averageBitrate.size () - 1)
+{
+  NS_LOG_INFO (this);
+  NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be => 0");
+  NS_ABORT_MSG_IF (m_videoData.segmentQuality.empty (), "The quality-aware algorithm needs the segment qualities, see SegmentQualityFilePath");
+}
+
+algorithmReply
+QualityAwareAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
+{
+  int64_t timeNow = Now ();
+  algorithmReply answer;
+  answer.decisionTime = timeNow;
+  answer.nextDownloadDelay = 0;
+  answer.delayDecisionCase = 0;
+
+  if (segmentCounter == 0 || m_throughput.transmissionEnd.empty ())
+    {
+      answer.nextRepIndex = 0;
+      answer.decisionCase = 0;
+      return answer;
+    }
+  int64_t bufferNow = std::max ((int64_t) 0, m_bufferData.bufferLevelNew.back () - (timeNow - m_throughput.transmissionEnd.back ()));
+
+  // harmonic mean of the throughput of the last 5 segments
+  double harmonicMeanDenominator = 0;
+  uint32_t samples = 0;
+  for (unsigned sd = m_throughput.transmissionEnd.size (); sd-- > 0 && samples < 5; )
+    {
+      double transmissionTime = (m_throughput.transmissionEnd.at (sd) - m_throughput.transmissionRequested.at (sd) - m_throughput.transmissionIdle.at (sd)) / 1000000.0;
+      if (m_throughput.bytesReceived.at (sd) == 0 || transmissionTime <= 0)
+        {
+          continue;
+        }
+      harmonicMeanDenominator += transmissionTime / (8.0 * m_throughput.bytesReceived.at (sd));
+      samples++;
+    }
+  if (samples == 0)
+    {
+      answer.nextRepIndex = 0;
+      answer.decisionCase = 0;
+      return answer;
+    }
+  double thrptEstimation = samples / harmonicMeanDenominator;
+
+  // a download may take as long as playing the segment plus the buffer above m_minBuffer
+  int64_t segmentIndex = std::min (m_playbackData.firstSegmentIndex + segmentCounter, (int64_t) m_videoData.segmentSize.at (0).size () - 1);
+  double downloadBudget = (std::max ((int64_t) 0, bufferNow - m_minBuffer.GetMicroSeconds ()) + m_videoData.segmentDuration) / 1000000.0;
+  int64_t highestFeasible = 0;
+  for (int64_t i = 1; i <= m_highestRepIndex; i++)
+    {
+      if (8.0 * m_videoData.segmentSize.at (i).at (segmentIndex) / thrptEstimation <= downloadBudget)
+        {
+          highestFeasible = i;
+        }
+    }
+  double bestQuality = m_videoData.segmentQuality.at (0).at (segmentIndex);
+  for (int64_t i = 1; i <= highestFeasible; i++)
+    {
+      bestQuality = std::max (bestQuality, m_videoData.segmentQuality.at (i).at (segmentIndex));
+    }
+  // the smallest feasible representation that looks as good as the best one
+  answer.nextRepIndex = highestFeasible;
+  answer.decisionCase = 1;
+  for (int64_t i = 0; i < highestFeasible; i++)
+    {
+      if (m_videoData.segmentQuality.at (i).at (segmentIndex) >= bestQuality - m_qualityTolerance)
+        {
+          answer.nextRepIndex = i;
+          answer.decisionCase = 2;
+          break;
+        }
+    }
+
+  if (bufferNow > m_maxBuffer.GetMicroSeconds ())
+    {
+      answer.nextDownloadDelay = bufferNow - m_maxBuffer.GetMicroSeconds ();
+      answer.delayDecisionCase = 1;
+    }
+  return answer;
+}
+
+} // namespace ns3
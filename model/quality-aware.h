@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUALITY_AWARE_ALGORITHM_H
+#define QUALITY_AWARE_ALGORITHM_H
+
+#include "tcp-stream-adaptation-algorithm.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief An adaptation algorithm deciding on the perceptual quality of the next segment instead of its bitrate
+ *
+ * Among the representations of the next segment that can be downloaded without draining the buffer below
+ * MinBuffer at the estimated throughput, the algorithm picks the smallest one whose quality is within
+ * QualityTolerance of the best of them. Segments of static scenes, where higher representations hardly improve
+ * the quality, are thus downloaded in lower representations, saving bandwidth at equal perceived quality.
+ *
+ * Requires the segment qualities, see TcpStreamClient attribute SegmentQualityFilePath.
+ */
+class QualityAwareAlgorithm : public AdaptationAlgorithm
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QualityAwareAlgorithm (  const videoData &videoData,
+                           const playbackData & playbackData,
+                           const bufferData & bufferData,
+                           const throughputData & throughput);
+
+  algorithmReply GetNextRep (const int64_t segmentCounter, int64_t clientId);
+
+private:
+  Time m_minBuffer; //!< The buffer level a download must not drain the buffer below
+  Time m_maxBuffer; //!< The buffer level above which the next download is delayed
+  double m_qualityTolerance; //!< The quality difference to the best feasible representation considered imperceptible
+  const int64_t m_highestRepIndex;
+};
+
+} // namespace ns3
+#endif /* QUALITY_AWARE_ALGORITHM_H */
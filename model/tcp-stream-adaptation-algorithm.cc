@@ -16,6 +16,8 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 #include "tcp-stream-adaptation-algorithm.h"
+#include "ns3/string.h"
+#include <sstream>
 
 namespace ns3 {
 
@@ -23,6 +25,28 @@ NS_LOG_COMPONENT_DEFINE ("AdaptationAlgorithm");
 
 NS_OBJECT_ENSURE_REGISTERED (AdaptationAlgorithm);
 
+/**
+ * \brief The algorithms registered, by name, with the attributes set on creation.
+ *
+ * A function-local static, so algorithms registering while the module is loaded find it constructed.
+ */
+static std::map<std::string, std::pair<AdaptationAlgorithm::Creator, std::string> > &
+AlgorithmRegistry (void)
+{
+  static std::map<std::string, std::pair<AdaptationAlgorithm::Creator, std::string> > registry;
+  return registry;
+}
+
+TypeId
+AdaptationAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AdaptationAlgorithm")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+  ;
+  return tid;
+}
+
 AdaptationAlgorithm::AdaptationAlgorithm (  const videoData & videoData,
                                             const playbackData & playbackData,
                                             const bufferData & bufferData,
@@ -30,8 +54,73 @@ AdaptationAlgorithm::AdaptationAlgorithm (  const videoData & videoData,
   m_videoData (videoData),
   m_bufferData (bufferData),
   m_throughput (throughput),
-  m_playbackData (playbackData)
+  m_playbackData (playbackData),
+  m_serverHints (NULL)
+{
+}
+
+void
+AdaptationAlgorithm::SetServerHints (const serverHints * hints)
+{
+  m_serverHints = hints;
+}
+
+void
+AdaptationAlgorithm::SetClock (Callback<int64_t> clock)
+{
+  m_clock = clock;
+}
+
+int64_t
+AdaptationAlgorithm::Now (void) const
+{
+  if (m_clock.IsNull ())
+    {
+      return Simulator::Now ().GetMicroSeconds ();
+    }
+  return m_clock ();
+}
+
+void
+AdaptationAlgorithm::Register (std::string name, Creator creator, std::string attributes)
+{
+  AlgorithmRegistry ()[name] = std::make_pair (creator, attributes);
+}
+
+Ptr<AdaptationAlgorithm>
+AdaptationAlgorithm::Create (std::string name,
+                             const videoData &videoData,
+                             const playbackData & playbackData,
+                             const bufferData & bufferData,
+                             const throughputData & throughput)
+{
+  std::map<std::string, std::pair<Creator, std::string> >::const_iterator it = AlgorithmRegistry ().find (name);
+  if (it == AlgorithmRegistry ().end ())
+    {
+      return 0;
+    }
+  Ptr<AdaptationAlgorithm> algorithm = it->second.first (videoData, playbackData, bufferData, throughput);
+  std::istringstream attributes (it->second.second);
+  std::string attribute;
+  while (std::getline (attributes, attribute, '|'))
+    {
+      std::string::size_type separator = attribute.find ('=');
+      NS_ASSERT_MSG (separator != std::string::npos, "Malformed attribute " << attribute << " of algorithm " << name);
+      algorithm->SetAttribute (attribute.substr (0, separator), StringValue (attribute.substr (separator + 1)));
+    }
+  return algorithm;
+}
+
+std::vector<std::string>
+AdaptationAlgorithm::GetRegisteredNames (void)
 {
+  std::vector<std::string> names;
+  for (std::map<std::string, std::pair<Creator, std::string> >::const_iterator it = AlgorithmRegistry ().begin ();
+       it != AlgorithmRegistry ().end (); ++it)
+    {
+      names.push_back (it->first);
+    }
+  return names;
 }
 
 } // namespace ns3
\ No newline at end of file
@@ -24,6 +24,7 @@
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
+#include "ns3/callback.h"
 #include <stdint.h>
 #include "tcp-stream-interface.h"
 #include <stdexcept>
@@ -31,6 +32,9 @@
 #include <math.h>
 #include <numeric>
 #include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace ns3 {
 /**
@@ -41,6 +45,17 @@ namespace ns3 {
 class AdaptationAlgorithm : public Object
 {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Function creating an adaptation algorithm working on the data of a client.
+   */
+  typedef Ptr<AdaptationAlgorithm> (*Creator)(const videoData &, const playbackData &, const bufferData &, const throughputData &);
+
   AdaptationAlgorithm ( const videoData &videoData,
                         const playbackData & playbackData,
                         const bufferData & bufferData,
@@ -56,12 +71,104 @@ public:
    */
   virtual algorithmReply GetNextRep ( const int64_t segmentCounter, int64_t clientId) = 0;
 
+  /**
+   * \brief Provide the hints the server piggybacks on its responses.
+   *
+   * Optional, algorithms that do not make use of server hints simply ignore them.
+   *
+   * \param hints the hints received by the client so far, owned by the client.
+   */
+  void SetServerHints (const serverHints * hints);
+
+  /**
+   * \brief Let the algorithm read the time from a clock other than the simulator, e.g. the DashEmulator's.
+   *
+   * \param clock returns the current time in microseconds
+   */
+  void SetClock (Callback<int64_t> clock);
+
+  /**
+   * \brief Make an algorithm available to the clients under a name, see NS_ADAPTATION_ALGORITHM_REGISTER.
+   *
+   * \param name the name clients choose the algorithm with, e.g. "tobasco" or "ns3::TobascoAlgorithm"
+   * \param creator the function creating the algorithm
+   * \param attributes attributes set on every algorithm created under this name, "Name=Value" pairs separated
+   *        by "|", e.g. to register variants of one algorithm
+   */
+  static void Register (std::string name, Creator creator, std::string attributes = "");
+
+  /**
+   * \brief Create the algorithm registered under a name.
+   *
+   * The attributes of the algorithm take their default values, which can be changed with Config::SetDefault
+   * or on the command line, e.g. --ns3::TobascoAlgorithm::A1=0.7.
+   *
+   * \return the algorithm, 0 if no algorithm is registered under the name
+   */
+  static Ptr<AdaptationAlgorithm> Create (std::string name,
+                                          const videoData &videoData,
+                                          const playbackData & playbackData,
+                                          const bufferData & bufferData,
+                                          const throughputData & throughput);
+
+  /**
+   * \return the names algorithms are registered under
+   */
+  static std::vector<std::string> GetRegisteredNames (void);
+
+  /**
+   * \brief Creator of algorithms of type T, with its attributes set, see Register.
+   */
+  template <typename T>
+  static Ptr<AdaptationAlgorithm> CreateAlgorithm (const videoData &videoData,
+                                                   const playbackData & playbackData,
+                                                   const bufferData & bufferData,
+                                                   const throughputData & throughput)
+  {
+    return CompleteConstruct (new T (videoData, playbackData, bufferData, throughput));
+  }
+
 protected:
+  /**
+   * \return the current time in microseconds, from the clock set with SetClock or else from the simulator
+   */
+  int64_t Now (void) const;
+
   const videoData & m_videoData;
   const bufferData & m_bufferData;
   const throughputData & m_throughput;
   const playbackData & m_playbackData;
+  const serverHints * m_serverHints; //!< Hints received from the server, NULL if not provided by the client
+  Callback<int64_t> m_clock; //!< The clock the algorithm reads the time from, the simulator's if null
 };
+
+/**
+ * \ingroup tcpStream
+ * \brief Registers algorithm T under its TypeId name and an alias when the module is loaded.
+ */
+template <typename T>
+struct AdaptationAlgorithmRegistrar
+{
+  /**
+   * \param alias the short name of the algorithm, e.g. "tobasco"
+   * \param attributes attributes set on every algorithm created under the alias, see AdaptationAlgorithm::Register
+   */
+  AdaptationAlgorithmRegistrar (std::string alias, std::string attributes = "")
+  {
+    AdaptationAlgorithm::Register (T::GetTypeId ().GetName (), &AdaptationAlgorithm::CreateAlgorithm<T>);
+    AdaptationAlgorithm::Register (alias, &AdaptationAlgorithm::CreateAlgorithm<T>, attributes);
+  }
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Register an adaptation algorithm, to be used once in the source file of the algorithm.
+ *
+ * \param type the class of the algorithm, which needs a TypeId
+ * \param name the short name clients choose the algorithm with
+ */
+#define NS_ADAPTATION_ALGORITHM_REGISTER(type, name) \
+  static AdaptationAlgorithmRegistrar<type> g_ ## type ## Registrar (name)
 } // namespace ns3
 
 #endif /* ADAPTATION_ALGORITHM_H */
\ No newline at end of file
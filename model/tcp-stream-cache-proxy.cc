@@ -0,0 +1,425 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "ns3/log.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "tcp-stream-cache-proxy.h"
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamCacheProxyApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamCacheProxy);
+
+TypeId
+TcpStreamCacheProxy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamCacheProxy")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamCacheProxy> ()
+    .AddAttribute ("Port", "Port on which we listen for incoming requests.",
+                   UintegerValue (9),
+                   MakeUintegerAccessor (&TcpStreamCacheProxy::m_port),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("OriginAddress",
+                   "The address of the origin server cache misses are fetched from",
+                   AddressValue (),
+                   MakeAddressAccessor (&TcpStreamCacheProxy::m_originAddress),
+                   MakeAddressChecker ())
+    .AddAttribute ("OriginPort",
+                   "The port of the origin server cache misses are fetched from",
+                   UintegerValue (9),
+                   MakeUintegerAccessor (&TcpStreamCacheProxy::m_originPort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("CacheCapacity",
+                   "The maximum number of bytes in the cache",
+                   UintegerValue (100000000),
+                   MakeUintegerAccessor (&TcpStreamCacheProxy::m_cacheCapacity),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddTraceSource ("RequestServed",
+                     "The last byte of a segment was sent to a client",
+                     MakeTraceSourceAccessor (&TcpStreamCacheProxy::m_requestServedTrace),
+                     "ns3::TcpStreamCacheProxy::RequestServedCallback")
+  ;
+  return tid;
+}
+
+TcpStreamCacheProxy::TcpStreamCacheProxy ()
+{
+  NS_LOG_FUNCTION (this);
+  m_cacheOccupancy = 0;
+  m_hits = 0;
+  m_misses = 0;
+  m_hitBytes = 0;
+  m_missBytes = 0;
+  m_evictions = 0;
+}
+
+TcpStreamCacheProxy::~TcpStreamCacheProxy ()
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+}
+
+void
+TcpStreamCacheProxy::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_clients.clear ();
+  m_originToClient.clear ();
+  Application::DoDispose ();
+}
+
+void
+TcpStreamCacheProxy::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_socket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_port));
+      m_socket->Listen ();
+    }
+  m_socket->SetAcceptCallback (MakeNullCallback<bool, Ptr< Socket >, const Address &> (),
+                               MakeCallback (&TcpStreamCacheProxy::HandleAccept, this));
+  m_socket->SetCloseCallbacks (
+    MakeCallback (&TcpStreamCacheProxy::HandlePeerClose, this),
+    MakeCallback (&TcpStreamCacheProxy::HandlePeerError, this));
+}
+
+void
+TcpStreamCacheProxy::StopApplication ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+    }
+  for (std::map <Ptr<Socket>, Ptr<Socket> >::iterator it = m_originToClient.begin (); it != m_originToClient.end (); ++it)
+    {
+      it->first->Close ();
+      it->first->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+  m_originToClient.clear ();
+}
+
+void
+TcpStreamCacheProxy::HandleAccept (Ptr<Socket> s, const Address& from)
+{
+  NS_LOG_FUNCTION (this << s << from);
+  proxyClientData cd;
+  cd.originConnected = false;
+  cd.segmentSize = 0;
+  cd.availableBytes = 0;
+  cd.currentTxBytes = 0;
+  cd.hit = false;
+  cd.send = false;
+  m_clients [s] = cd;
+  s->SetRecvCallback (MakeCallback (&TcpStreamCacheProxy::HandleClientRead, this));
+  s->SetSendCallback (MakeCallback (&TcpStreamCacheProxy::HandleClientSend, this));
+}
+
+void
+TcpStreamCacheProxy::HandlePeerClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  // clients may still arrive later, the proxy keeps listening until its stop time
+  RemoveClient (socket);
+}
+
+void
+TcpStreamCacheProxy::HandlePeerError (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  RemoveClient (socket);
+}
+
+void
+TcpStreamCacheProxy::RemoveClient (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map <Ptr<Socket>, proxyClientData>::iterator it = m_clients.find (socket);
+  if (it == m_clients.end ())
+    {
+      return;
+    }
+  // every client has its own connection to the origin, it is not needed anymore once the client left
+  if (it->second.originSocket != 0)
+    {
+      it->second.originSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      it->second.originSocket->Close ();
+      m_originToClient.erase (it->second.originSocket);
+    }
+  socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+  m_clients.erase (it);
+}
+
+void
+TcpStreamCacheProxy::HandleClientRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet = socket->Recv ();
+  if (packet == 0 || packet->GetSize () == 0)
+    {
+      return;
+    }
+  uint8_t *buffer = new uint8_t [packet->GetSize () + 1];
+  packet->CopyData (buffer, packet->GetSize ());
+  buffer [packet->GetSize ()] = 0;
+  std::string request ((char *) buffer);
+  delete [] buffer;
+
+  proxyClientData & cd = m_clients [socket];
+  std::istringstream ss (request);
+  ss >> cd.segmentSize >> cd.key.videoId >> cd.key.repIndex >> cd.key.segmentIndex;
+  cd.availableBytes = 0;
+  cd.currentTxBytes = 0;
+  cd.send = true;
+  cd.requestReceived = Simulator::Now ();
+  cd.hit = CacheLookup (cd.key, cd.segmentSize);
+  if (cd.hit)
+    {
+      cd.availableBytes = cd.segmentSize;
+      HandleClientSend (socket, socket->GetTxAvailable ());
+    }
+  else
+    {
+      FetchFromOrigin (socket, request);
+    }
+}
+
+void
+TcpStreamCacheProxy::HandleClientSend (Ptr<Socket> socket, uint32_t txSpace)
+{
+  std::map <Ptr<Socket>, proxyClientData>::iterator it = m_clients.find (socket);
+  if (it == m_clients.end () || !it->second.send)
+    {
+      return;
+    }
+  proxyClientData & cd = it->second;
+  while (cd.currentTxBytes < cd.availableBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t toSend = std::min ((int64_t) socket->GetTxAvailable (), cd.availableBytes - cd.currentTxBytes);
+      int amountSent = socket->Send (Create<Packet> (toSend), 0);
+      if (amountSent <= 0)
+        {
+          // The send buffer is full, we continue when the SendCallback fires.
+          return;
+        }
+      if (cd.currentTxBytes == 0)
+        {
+          cd.firstByteSent = Simulator::Now ();
+        }
+      cd.currentTxBytes += amountSent;
+    }
+  if (cd.currentTxBytes == cd.segmentSize)
+    {
+      cd.send = false;
+      Time firstByteLatency = cd.firstByteSent - cd.requestReceived;
+      Time lastByteLatency = Simulator::Now () - cd.requestReceived;
+      if (cd.hit)
+        {
+          m_hits++;
+          m_hitBytes += cd.segmentSize;
+          m_hitLatency = m_hitLatency + lastByteLatency;
+        }
+      else
+        {
+          m_misses++;
+          m_missBytes += cd.segmentSize;
+          m_missLatency = m_missLatency + lastByteLatency;
+        }
+      NS_LOG_INFO ((cd.hit ? "Hit" : "Miss") << " video " << cd.key.videoId << " rep " << cd.key.repIndex
+                                             << " segment " << cd.key.segmentIndex << " served in " << lastByteLatency.GetSeconds () << "s");
+      m_requestServedTrace (cd.hit, cd.segmentSize, firstByteLatency, lastByteLatency);
+    }
+}
+
+void
+TcpStreamCacheProxy::FetchFromOrigin (Ptr<Socket> client, std::string request)
+{
+  NS_LOG_FUNCTION (this << client << request);
+  proxyClientData & cd = m_clients [client];
+  if (cd.originSocket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+      cd.originSocket = Socket::CreateSocket (GetNode (), tid);
+      if (Ipv4Address::IsMatchingType (m_originAddress) == true)
+        {
+          cd.originSocket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom (m_originAddress), m_originPort));
+        }
+      else if (Ipv6Address::IsMatchingType (m_originAddress) == true)
+        {
+          cd.originSocket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom (m_originAddress), m_originPort));
+        }
+      cd.originSocket->SetConnectCallback (
+        MakeCallback (&TcpStreamCacheProxy::OriginConnectionSucceeded, this),
+        MakeCallback (&TcpStreamCacheProxy::OriginConnectionFailed, this));
+      cd.originSocket->SetRecvCallback (MakeCallback (&TcpStreamCacheProxy::HandleOriginRead, this));
+      m_originToClient [cd.originSocket] = client;
+    }
+  if (!cd.originConnected)
+    {
+      cd.pendingRequest = request;
+      return;
+    }
+  cd.originSocket->Send (Create<Packet> ((const uint8_t *) request.c_str (), request.size () + 1));
+}
+
+void
+TcpStreamCacheProxy::OriginConnectionSucceeded (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map <Ptr<Socket>, Ptr<Socket> >::iterator it = m_originToClient.find (socket);
+  if (it == m_originToClient.end ())
+    {
+      return;
+    }
+  proxyClientData & cd = m_clients [it->second];
+  cd.originConnected = true;
+  if (!cd.pendingRequest.empty ())
+    {
+      FetchFromOrigin (it->second, cd.pendingRequest);
+      cd.pendingRequest.clear ();
+    }
+}
+
+void
+TcpStreamCacheProxy::OriginConnectionFailed (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  NS_LOG_LOGIC ("Tcp Stream Cache Proxy connection to origin failed");
+}
+
+void
+TcpStreamCacheProxy::HandleOriginRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map <Ptr<Socket>, Ptr<Socket> >::iterator it = m_originToClient.find (socket);
+  Ptr<Packet> packet;
+  while ( (packet = socket->Recv ()) )
+    {
+      if (it == m_originToClient.end () || m_clients.find (it->second) == m_clients.end ())
+        {
+          continue;
+        }
+      proxyClientData & cd = m_clients [it->second];
+      cd.availableBytes += packet->GetSize ();
+      if (cd.availableBytes == cd.segmentSize)
+        {
+          CacheInsert (cd.key, cd.segmentSize);
+        }
+    }
+  if (it != m_originToClient.end ())
+    {
+      HandleClientSend (it->second, it->second->GetTxAvailable ());
+    }
+}
+
+bool
+TcpStreamCacheProxy::CacheLookup (const cacheKey & key, int64_t segmentSize)
+{
+  std::map<cacheKey, std::pair<int64_t, std::list<cacheKey>::iterator> >::iterator it = m_cache.find (key);
+  if (it == m_cache.end () || it->second.first != segmentSize)
+    {
+      return false;
+    }
+  m_lru.splice (m_lru.begin (), m_lru, it->second.second);
+  return true;
+}
+
+void
+TcpStreamCacheProxy::CacheInsert (const cacheKey & key, int64_t segmentSize)
+{
+  if ((uint64_t) segmentSize > m_cacheCapacity || m_cache.find (key) != m_cache.end ())
+    {
+      return;
+    }
+  while (m_cacheOccupancy + segmentSize > m_cacheCapacity)
+    {
+      std::map<cacheKey, std::pair<int64_t, std::list<cacheKey>::iterator> >::iterator victim = m_cache.find (m_lru.back ());
+      m_cacheOccupancy -= victim->second.first;
+      m_cache.erase (victim);
+      m_lru.pop_back ();
+      m_evictions++;
+    }
+  m_lru.push_front (key);
+  m_cache [key] = std::make_pair (segmentSize, m_lru.begin ());
+  m_cacheOccupancy += segmentSize;
+}
+
+uint64_t
+TcpStreamCacheProxy::GetHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+TcpStreamCacheProxy::GetMisses (void) const
+{
+  return m_misses;
+}
+
+uint64_t
+TcpStreamCacheProxy::GetHitBytes (void) const
+{
+  return m_hitBytes;
+}
+
+uint64_t
+TcpStreamCacheProxy::GetMissBytes (void) const
+{
+  return m_missBytes;
+}
+
+uint64_t
+TcpStreamCacheProxy::GetEvictions (void) const
+{
+  return m_evictions;
+}
+
+uint64_t
+TcpStreamCacheProxy::GetCacheOccupancy (void) const
+{
+  return m_cacheOccupancy;
+}
+
+void
+TcpStreamCacheProxy::PrintStatistics (std::ostream & os) const
+{
+  os << "Hits Misses Hit_Bytes Miss_Bytes Evictions Cache_Occupancy Avg_Hit_Latency Avg_Miss_Latency\n"
+     << m_hits << " " << m_misses << " " << m_hitBytes << " " << m_missBytes << " " << m_evictions << " "
+     << m_cacheOccupancy << " "
+     << (m_hits > 0 ? m_hitLatency.GetSeconds () / m_hits : 0.0) << " "
+     << (m_misses > 0 ? m_missLatency.GetSeconds () / m_misses : 0.0) << "\n";
+}
+
+} // Namespace ns3
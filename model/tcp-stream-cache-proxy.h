@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_CACHE_PROXY_H
+#define TCP_STREAM_CACHE_PROXY_H
+
+#include "ns3/application.h"
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include <map>
+#include <list>
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup tcpStream
+ * \brief Identifies a segment in the cache of a TcpStreamCacheProxy.
+ */
+struct cacheKey
+{
+  uint32_t videoId; //!< the Id of the video the segment belongs to
+  int64_t repIndex; //!< the representation level index of the segment
+  int64_t segmentIndex; //!< the index of the segment
+
+  bool operator< (const cacheKey & other) const
+  {
+    if (videoId != other.videoId)
+      {
+        return videoId < other.videoId;
+      }
+    if (repIndex != other.repIndex)
+      {
+        return repIndex < other.repIndex;
+      }
+    return segmentIndex < other.segmentIndex;
+  }
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief data structure the proxy uses to manage the request of every connected client separately.
+ */
+struct proxyClientData
+{
+  Ptr<Socket> originSocket; //!< connection to the origin server, used to fetch this client's cache misses
+  bool originConnected; //!< true once the connection to the origin server is established
+  std::string pendingRequest; //!< request to forward to the origin server as soon as the connection is established
+  cacheKey key; //!< the segment currently requested by the client
+  int64_t segmentSize; //!< total amount of bytes that have to be returned to the client
+  int64_t availableBytes; //!< bytes of the segment that can be sent, i.e. the whole segment for a hit, the bytes already received from the origin for a miss
+  int64_t currentTxBytes; //!< already sent bytes for the current segment
+  bool hit; //!< true if the current segment is served from the cache
+  bool send; //!< true as long as there are still bytes left to be sent for the current segment
+  Time requestReceived; //!< point in time when the request for the current segment was received
+  Time firstByteSent; //!< point in time when the first byte of the current segment was sent
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief A caching proxy between Tcp Stream clients and a Tcp Stream server
+ *
+ * The proxy is installed on an intermediate node, e.g. the access point, and is addressed by the clients
+ * instead of the server. Segments are cached in a least recently used cache bounded by m_cacheCapacity bytes
+ * and keyed by video, representation and segment index, which the clients send along with their requests.
+ * Hits are served from the cache. Misses are requested from the origin server over a connection the proxy
+ * opens for every client and are forwarded to the client while they arrive. The segment payload itself is
+ * not relayed, so hints a server piggybacks on its responses do not reach the clients.
+ */
+class TcpStreamCacheProxy : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  TcpStreamCacheProxy ();
+  virtual ~TcpStreamCacheProxy ();
+
+  /**
+   * TracedCallback signature for served requests.
+   *
+   * \param hit true if the segment was served from the cache
+   * \param bytes the size of the segment in bytes
+   * \param firstByteLatency the time from receiving the request until the first byte was sent to the client
+   * \param lastByteLatency the time from receiving the request until the last byte was sent to the client
+   */
+  typedef void (* RequestServedCallback)(bool hit, int64_t bytes, Time firstByteLatency, Time lastByteLatency);
+
+  uint64_t GetHits (void) const; //!< \return the number of requests served from the cache
+  uint64_t GetMisses (void) const; //!< \return the number of requests fetched from the origin server
+  uint64_t GetHitBytes (void) const; //!< \return the number of bytes served from the cache
+  uint64_t GetMissBytes (void) const; //!< \return the number of bytes fetched from the origin server
+  uint64_t GetEvictions (void) const; //!< \return the number of segments evicted from the cache
+  uint64_t GetCacheOccupancy (void) const; //!< \return the number of bytes currently in the cache
+
+  /**
+   * \brief Print hit and miss counts, served bytes, evictions and average latencies of hits and misses.
+   * \param os the output stream to print to
+   */
+  void PrintStatistics (std::ostream & os) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  void HandleAccept (Ptr<Socket> s, const Address& from);
+  void HandlePeerClose (Ptr<Socket> socket);
+  void HandlePeerError (Ptr<Socket> socket);
+
+  /**
+   * \brief Forget a client that left and close its connection to the origin server.
+   * \param socket the socket of the client.
+   */
+  void RemoveClient (Ptr<Socket> socket);
+
+  /**
+   * \brief Handle a request of a client.
+   *
+   * The request is looked up in the cache. A hit can be sent right away, a miss is forwarded to the origin server.
+   *
+   * \param socket the socket of the client the request was received to.
+   */
+  void HandleClientRead (Ptr<Socket> socket);
+
+  /**
+   * \brief Send the available bytes of the current segment to the client.
+   *
+   * Called after a request was received, whenever bytes of a miss arrived from the origin
+   * and through the SendCallback when space in the send buffer has freed up.
+   *
+   * \param socket the socket of the client.
+   * \param txSpace the space available in the send buffer.
+   */
+  void HandleClientSend (Ptr<Socket> socket, uint32_t txSpace);
+
+  /**
+   * \brief Forward a request to the origin server, connecting to it first if necessary.
+   * \param client the socket of the client the request was received from.
+   * \param request the request as received from the client.
+   */
+  void FetchFromOrigin (Ptr<Socket> client, std::string request);
+
+  void OriginConnectionSucceeded (Ptr<Socket> socket);
+  void OriginConnectionFailed (Ptr<Socket> socket);
+
+  /**
+   * \brief Handle data received from the origin server and make it available for sending to the client.
+   * \param socket the socket of the origin connection.
+   */
+  void HandleOriginRead (Ptr<Socket> socket);
+
+  /**
+   * \brief Look up a segment, marking it as most recently used if found.
+   * \return true on a hit
+   */
+  bool CacheLookup (const cacheKey & key, int64_t segmentSize);
+
+  /**
+   * \brief Insert a segment into the cache, evicting least recently used segments until it fits.
+   */
+  void CacheInsert (const cacheKey & key, int64_t segmentSize);
+
+  uint16_t m_port; //!< Port on which we listen for incoming requests
+  Address m_originAddress; //!< Address of the origin server
+  uint16_t m_originPort; //!< Port of the origin server
+  uint64_t m_cacheCapacity; //!< Maximum number of bytes in the cache
+  Ptr<Socket> m_socket; //!< Listening socket
+  std::map <Ptr<Socket>, proxyClientData> m_clients; //!< State of every connected client, accessed through the client's socket
+  std::map <Ptr<Socket>, Ptr<Socket> > m_originToClient; //!< The client socket belonging to an origin connection
+
+  std::list<cacheKey> m_lru; //!< Cached segments, most recently used first
+  std::map<cacheKey, std::pair<int64_t, std::list<cacheKey>::iterator> > m_cache; //!< Size and position in m_lru of every cached segment
+  uint64_t m_cacheOccupancy; //!< Number of bytes currently in the cache
+
+  uint64_t m_hits; //!< Number of requests served from the cache
+  uint64_t m_misses; //!< Number of requests fetched from the origin server
+  uint64_t m_hitBytes; //!< Bytes served from the cache
+  uint64_t m_missBytes; //!< Bytes fetched from the origin server
+  uint64_t m_evictions; //!< Number of segments evicted from the cache
+  Time m_hitLatency; //!< Sum of the last byte latencies of all hits
+  Time m_missLatency; //!< Sum of the last byte latencies of all misses
+
+  TracedCallback<bool, int64_t, Time, Time> m_requestServedTrace; //!< Fired when the last byte of a segment was sent to a client
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_CACHE_PROXY_H */
@@ -26,6 +26,9 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/integer.h"
 #include "ns3/trace-source-accessor.h"
 #include "tcp-stream-client.h"
 #include <math.h>
@@ -35,6 +38,8 @@
 #include "ns3/global-value.h"
 #include <ns3/core-module.h>
 #include "tcp-stream-server.h"
+#include "dash-profiler.h"
+#include "video-catalog.h"
 #include <unistd.h>
 #include <iterator>
 #include <numeric>
@@ -63,16 +68,32 @@ void
 TcpStreamClient::Controller (controllerEvent event)
 {
   NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::Controller");
   if (state == initial)
     {
+      if (m_live && !JoinLiveStream ())
+        {
+          return;
+        }
       RequestRepIndex ();
       state = downloading;
-      Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
+      RequestSegment ();
       return;
     }
 
   if (state == downloading)
     {
+      if (event == chunkReceived)
+        {
+          /*  with chunked delivery, playback starts as soon as a chunk is in the buffer  */
+          PlaybackHandle ();
+          state = downloadingPlaying;
+          controllerEvent ev = playbackFinished;
+          m_scheduledEvents++;
+          DASH_PROFILE_COUNT ("Schedule playbackFinished");
+          Simulator::Schedule (MicroSeconds (PlaybackDuration ()), &TcpStreamClient::Controller, this, ev);
+          return;
+        }
       PlaybackHandle ();
       if (m_currentPlaybackIndex <= m_lastSegmentIndex)
         {
@@ -80,7 +101,7 @@ TcpStreamClient::Controller (controllerEvent event)
           m_segmentCounter++;
           RequestRepIndex ();
           state = downloadingPlaying;
-          Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
+          RequestSegment ();
         }
       else
         {
@@ -89,7 +110,9 @@ TcpStreamClient::Controller (controllerEvent event)
         }
       controllerEvent ev = playbackFinished;
       // std::cerr << "Client " << m_clientId << " " << Simulator::Now ().GetSeconds () << "\n";
-      Simulator::Schedule (MicroSeconds (m_videoData.segmentDuration), &TcpStreamClient::Controller, this, ev);
+      m_scheduledEvents++;
+      DASH_PROFILE_COUNT ("Schedule playbackFinished");
+      Simulator::Schedule (MicroSeconds (PlaybackDuration ()), &TcpStreamClient::Controller, this, ev);
       return;
     }
 
@@ -108,7 +131,16 @@ TcpStreamClient::Controller (controllerEvent event)
             {
               /*  e_dirs */
               state = playing;
+              if (m_push && !m_pushPaused)
+                {
+                  // keep the server from filling the buffer while the algorithm holds the download back
+                  std::string message = "PAUSE";
+                  Send (message);
+                  m_pushPaused = true;
+                }
               controllerEvent ev = irdFinished;
+              m_scheduledEvents++;
+              DASH_PROFILE_COUNT ("Schedule irdFinished");
               Simulator::Schedule (MicroSeconds (m_bDelay), &TcpStreamClient::Controller, this, ev);
             }
           else if (m_segmentCounter == m_lastSegmentIndex)
@@ -119,7 +151,7 @@ TcpStreamClient::Controller (controllerEvent event)
           else
             {
               /*  e_d  */
-              Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
+              RequestSegment ();
             }
         }
       else if (event == playbackFinished)
@@ -129,7 +161,9 @@ TcpStreamClient::Controller (controllerEvent event)
               /*  e_pb  */
               controllerEvent ev = playbackFinished;
               // std::cerr << "FIRST CASE. Client " << m_clientId << " " << Simulator::Now ().GetSeconds () << "\n";
-              Simulator::Schedule (MicroSeconds (m_videoData.segmentDuration), &TcpStreamClient::Controller, this, ev);
+              m_scheduledEvents++;
+              DASH_PROFILE_COUNT ("Schedule playbackFinished");
+              Simulator::Schedule (MicroSeconds (PlaybackDuration ()), &TcpStreamClient::Controller, this, ev);
             }
           else
             {
@@ -147,15 +181,17 @@ TcpStreamClient::Controller (controllerEvent event)
         {
           /*  e_irc  */
           state = downloadingPlaying;
-          Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
+          RequestSegment ();
         }
-      else if (event == playbackFinished && m_currentPlaybackIndex < m_lastSegmentIndex)
+      else if (event == playbackFinished && (m_currentPlaybackIndex < m_lastSegmentIndex || m_playbackChunk < m_chunksPerSegment - 1))
         {
           /*  e_pb  */
           // std::cerr << "SECOND CASE. Client " << m_clientId << " " << Simulator::Now ().GetSeconds () << "\n";
           PlaybackHandle ();
           controllerEvent ev = playbackFinished;
-          Simulator::Schedule (MicroSeconds (m_videoData.segmentDuration), &TcpStreamClient::Controller, this, ev);
+          m_scheduledEvents++;
+          DASH_PROFILE_COUNT ("Schedule playbackFinished");
+          Simulator::Schedule (MicroSeconds (PlaybackDuration ()), &TcpStreamClient::Controller, this, ev);
         }
       else if (event == playbackFinished && m_currentPlaybackIndex == m_lastSegmentIndex)
         {
@@ -195,6 +231,11 @@ TcpStreamClient::GetTypeId (void)
                    StringValue ("bitrates.txt"),
                    MakeStringAccessor (&TcpStreamClient::m_segmentSizeFilePath),
                    MakeStringChecker ())
+    .AddAttribute ("SegmentQualityFilePath",
+                   "The relative path (from ns-3.x directory) to the file containing the perceptual quality of every segment, empty if not provided",
+                   StringValue (""),
+                   MakeStringAccessor (&TcpStreamClient::m_segmentQualityFilePath),
+                   MakeStringChecker ())
     .AddAttribute ("SimulationId",
                    "The ID of the current simulation, for logging purposes",
                    UintegerValue (0),
@@ -204,12 +245,85 @@ TcpStreamClient::GetTypeId (void)
                    "The total number of clients for this simulation, for logging purposes",
                    UintegerValue (1),
                    MakeUintegerAccessor (&TcpStreamClient::m_numberOfClients),
-                   MakeUintegerChecker<uint16_t> ())
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("ClientId",
                    "The ID of the this client object, for logging purposes",
                    UintegerValue (0),
                    MakeUintegerAccessor (&TcpStreamClient::m_clientId),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("VideoId",
+                   "The ID of the video this client streams, sent along with every segment request so caches can tell videos apart",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpStreamClient::m_videoId),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("SwitchMargin",
+                   "The relative margin by which a candidate server has to outperform the current one for the client to switch",
+                   DoubleValue (0.2),
+                   MakeDoubleAccessor (&TcpStreamClient::m_switchMargin),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MinSegmentsBetweenSwitches",
+                   "The minimum number of segments to download from a server before switching to another one",
+                   IntegerValue (3),
+                   MakeIntegerAccessor (&TcpStreamClient::m_minSegmentsBetweenSwitches),
+                   MakeIntegerChecker<int64_t> (1, 1000000))
+    .AddAttribute ("ServerStatsSmoothing",
+                   "The weight of the newest segment in the smoothed throughput and round trip time of a server",
+                   DoubleValue (0.3),
+                   MakeDoubleAccessor (&TcpStreamClient::m_serverStatsSmoothing),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("SwitchDelay",
+                   "The setup cost of a server switch on top of the TCP connection setup, e.g. for a TLS handshake",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TcpStreamClient::m_switchDelay),
+                   MakeTimeChecker ())
+    .AddAttribute ("Live",
+                   "If true, the video is a live stream whose segments become available one after the other, and the client starts at the live edge",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpStreamClient::m_live),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AvailabilityStartTime",
+                   "The point in time the live stream started, segment i becomes available at AvailabilityStartTime + (i+1) * SegmentDuration",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TcpStreamClient::m_availabilityStartTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("TargetLatency",
+                   "The latency to the live edge the playback rate control of a live client aims at",
+                   TimeValue (Seconds (6)),
+                   MakeTimeAccessor (&TcpStreamClient::m_targetLatency),
+                   MakeTimeChecker (MicroSeconds (1)))
+    .AddAttribute ("MaxPlaybackRateChange",
+                   "The maximum deviation of the playback rate from 1 a live client uses to hold the target latency",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&TcpStreamClient::m_maxPlaybackRateChange),
+                   MakeDoubleChecker<double> (0.0, 0.5))
+    .AddTraceSource ("LiveLatency",
+                     "The latency to the live edge and the playback rate, whenever a segment starts playing",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_liveLatencyTrace),
+                     "ns3::TcpStreamClient::LiveLatencyCallback")
+    .AddTraceSource ("SessionFinished",
+                     "The streaming session ended, because the video was over or the client was stopped before, e.g. when the viewer left",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_sessionFinishedTrace),
+                     "ns3::TcpStreamClient::SessionFinishedCallback")
+    .AddAttribute ("Chunks",
+                   "The number of chunks a segment is split into for chunked delivery, playback can start once the first chunk of a segment is received. 1 disables chunking",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpStreamClient::m_chunksPerSegment),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Push",
+                   "If true, the client subscribes once and the server pushes the segments, instead of the client requesting every segment",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpStreamClient::m_push),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BatchSize",
+                   "The maximum number of consecutive segments requested in one request while the buffer is above BatchThreshold, 1 disables batching",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpStreamClient::m_batchSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BatchThreshold",
+                   "The buffer level from which on segments are requested in batches",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&TcpStreamClient::m_batchThreshold),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -226,44 +340,58 @@ TcpStreamClient::TcpStreamClient ()
   m_segmentCounter = 0;
   m_bDelay = 0;
   m_bytesReceived = 0;
-  m_segmentsInBuffer = 0;
+  m_chunksInBuffer = 0;
+  m_chunksPerSegment = 1;
+  m_chunksReceived = 0;
+  m_playbackChunk = 0;
+  m_firstChunkReleased = 0;
+  m_lastChunkEnd = 0;
+  m_transmissionIdle = 0;
+  m_receivingSegmentSize = 0;
+  m_push = false;
+  m_pushSubscribed = false;
+  m_pushPaused = false;
+  m_waitingForSegment = false;
+  m_pushRepIndex = 0;
+  m_receivingSegmentIndex = 0;
+  m_receivingRepIndex = 0;
+  m_receivingRequested = 0;
+  m_lastSegmentEnd = 0;
+  m_applicationStart = 0;
+  m_batchSize = 1;
+  m_lastRequestedSegment = -1;
+  m_requestsSent = 0;
+  m_scheduledEvents = 0;
   m_bufferUnderrun = false;
   m_currentPlaybackIndex = 0;
+  m_currentServer = 0;
+  m_switching = false;
+  m_previousServer = 0;
+  m_sessionFinished = false;
+  m_segmentsSinceSwitch = 0;
+  m_bestServerThroughput = 0;
+  m_requestSentToServer = 0;
+  m_fluidNetwork = 0;
+  m_fluidPath = 0;
+  m_videoData = 0;
+  m_playbackRate = 1;
+  m_playbackData.firstSegmentIndex = 0;
 
 }
 
 void
-TcpStreamClient::Initialise (std::string algorithm, uint16_t clientId)
+TcpStreamClient::Initialise (std::string algorithm, uint32_t clientId)
 {
   NS_LOG_FUNCTION (this);
-  m_videoData.segmentDuration = m_segmentDuration;
-  if (ReadInBitrateValues (ToString (m_segmentSizeFilePath)) == -1)
-    {
-      NS_LOG_ERROR ("Opening test bitrate file failed. Terminating.\n");
-      Simulator::Stop ();
-      Simulator::Destroy ();
-    }
-  m_lastSegmentIndex = (int64_t) m_videoData.segmentSize.at (0).size () - 1;
-  m_highestRepIndex = m_videoData.averageBitrate.size () - 1;
-  if (algorithm == "tobasco")
-    {
-      algo = new TobascoAlgorithm (m_videoData, m_playbackData, m_bufferData, m_throughput);
-    }
-  else if (algorithm == "panda")
-    {
-      algo = new PandaAlgorithm (m_videoData, m_playbackData, m_bufferData, m_throughput);
-    }
-  else if (algorithm == "festive")
-    {
-      algo = new FestiveAlgorithm (m_videoData, m_playbackData, m_bufferData, m_throughput);
-    }
-  else
-    {
-      NS_LOG_ERROR ("Invalid algorithm name entered. Terminating.");
-      StopApplication ();
-      Simulator::Stop ();
-      Simulator::Destroy ();
-    }
+  // clients streaming the same video share its manifest
+  m_videoData = VideoCatalog::GetManifest (m_segmentSizeFilePath, m_segmentQualityFilePath, m_segmentDuration);
+  NS_ABORT_MSG_IF (m_videoData == 0, "Opening the segment size file " << m_segmentSizeFilePath
+                   << " or the segment quality file " << m_segmentQualityFilePath << " failed. Terminating.");
+  m_lastSegmentIndex = (int64_t) m_videoData->segmentSize.at (0).size () - 1;
+  m_highestRepIndex = m_videoData->averageBitrate.size () - 1;
+  algo = AdaptationAlgorithm::Create (algorithm, *m_videoData, m_playbackData, m_bufferData, m_throughput);
+  NS_ABORT_MSG_IF (algo == 0, "Invalid algorithm name " << algorithm << ". Terminating.");
+  algo->SetServerHints (&m_serverHints);
 
   m_algoName = algorithm;
 
@@ -276,8 +404,7 @@ TcpStreamClient::~TcpStreamClient ()
   NS_LOG_FUNCTION (this);
   m_socket = 0;
 
-  delete algo;
-  algo = NULL;
+  algo = 0;
   delete [] m_data;
   m_data = 0;
   m_dataSize = 0;
@@ -287,6 +414,7 @@ void
 TcpStreamClient::RequestRepIndex ()
 {
   NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::RequestRepIndex");
   algorithmReply answer;
 
   answer = algo->GetNextRep ( m_segmentCounter, m_clientId );
@@ -299,6 +427,99 @@ TcpStreamClient::RequestRepIndex ()
   LogAdaptation (answer);
 }
 
+void
+TcpStreamClient::RequestSegment ()
+{
+  NS_LOG_FUNCTION (this);
+  if (state == terminal)
+    {
+      return;
+    }
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  if (m_live && !m_push)
+    {
+      int64_t available = SegmentAvailabilityTime (m_playbackData.firstSegmentIndex + m_segmentCounter);
+      if (available > timeNow)
+        {
+          // the segment does not exist yet, request it as soon as it is published
+          m_scheduledEvents++;
+          DASH_PROFILE_COUNT ("Schedule RequestSegment");
+          Simulator::Schedule (MicroSeconds (available - timeNow), &TcpStreamClient::RequestSegment, this);
+          return;
+        }
+    }
+  m_downloadRequestSent = timeNow;
+  // a batch is received on one connection, the server is only switched between batches
+  if (!m_candidates.empty () && !m_push
+      && m_playbackData.firstSegmentIndex + m_segmentCounter > m_lastRequestedSegment && SwitchServer ())
+    {
+      // the request is sent once the connection to the new server is established
+      return;
+    }
+  SendSegmentRequest ();
+}
+
+void
+TcpStreamClient::SendSegmentRequest ()
+{
+  NS_LOG_FUNCTION (this);
+  if (state == terminal)
+    {
+      return;
+    }
+  if (m_push)
+    {
+      RequestPushedSegment ();
+      return;
+    }
+  int64_t segmentIndex = m_playbackData.firstSegmentIndex + m_segmentCounter;
+  if (m_fluidNetwork != 0)
+    {
+      m_requestSentToServer = Simulator::Now ().GetMicroSeconds ();
+      m_requestsSent++;
+      m_fluidNetwork->StartFlow (m_fluidPath, m_videoData->segmentSize.at (m_currentRepIndex).at (segmentIndex),
+                                 MakeCallback (&TcpStreamClient::FluidTransmissionStart, this),
+                                 MakeCallback (&TcpStreamClient::FluidTransmissionEnd, this));
+      return;
+    }
+  int64_t batch = 1;
+  if (m_batchSize > 1)
+    {
+      if (segmentIndex <= m_lastRequestedSegment)
+        {
+          // requested with an earlier batch already
+          WaitForSegment ();
+          return;
+        }
+      batch = BatchLength (segmentIndex);
+      for (int64_t i = 0; i < batch; i++)
+        {
+          m_batchSegments.push_back (std::make_pair (segmentIndex + i, m_currentRepIndex));
+        }
+      m_lastRequestedSegment = segmentIndex + batch - 1;
+      m_lastSegmentEnd = Simulator::Now ().GetMicroSeconds ();
+      m_firstChunkReleased = 0;
+      m_waitingForSegment = true;
+    }
+  m_receivingSegmentSize = m_videoData->segmentSize.at (m_currentRepIndex).at (segmentIndex);
+  int64_t requestSize = 0;
+  for (int64_t i = 0; i < batch; i++)
+    {
+      requestSize += m_videoData->segmentSize.at (m_currentRepIndex).at (segmentIndex + i);
+    }
+  std::ostringstream request;
+  request << requestSize << " "
+          << m_videoId << " " << m_currentRepIndex << " " << segmentIndex;
+  if (m_chunksPerSegment > 1 && batch == 1)
+    {
+      // live chunks are sent as they are encoded, chunks of a video on demand are all available at once
+      m_firstChunkReleased = m_live ? SegmentAvailabilityTime (m_playbackData.firstSegmentIndex + m_segmentCounter) : 0;
+      request << " " << m_chunksPerSegment << " " << m_firstChunkReleased << " " << m_videoData->segmentDuration / m_chunksPerSegment;
+    }
+  std::string message = request.str ();
+  Send (message);
+}
+
 template <typename T>
 void
 TcpStreamClient::Send (T & message)
@@ -307,7 +528,8 @@ TcpStreamClient::Send (T & message)
   PreparePacket (message);
   Ptr<Packet> p;
   p = Create<Packet> (m_data, m_dataSize);
-  m_downloadRequestSent = Simulator::Now ().GetMicroSeconds ();
+  m_requestSentToServer = Simulator::Now ().GetMicroSeconds ();
+  m_requestsSent++;
   m_socket->Send (p);
 }
 
@@ -315,7 +537,17 @@ void
 TcpStreamClient::HandleRead (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::HandleRead");
   Ptr<Packet> packet;
+  if (ReceivesSegmentStream ())
+    {
+      while ( (packet = socket->Recv ()) )
+        {
+          LogThroughput (packet->GetSize ());
+          HandleSegmentStream (packet);
+        }
+      return;
+    }
   if (m_bytesReceived == 0)
     {
       m_transmissionStartReceivingSegment = Simulator::Now ().GetMicroSeconds ();
@@ -325,49 +557,266 @@ TcpStreamClient::HandleRead (Ptr<Socket> socket)
     {
       packetSize = packet->GetSize ();
       LogThroughput (packetSize);
+      if (m_bytesReceived < serverHintsSize)
+        {
+          ReadHints (packet);
+        }
       m_bytesReceived += packetSize;
-      if (m_bytesReceived == m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter))
+      while (m_chunksReceived < m_chunksPerSegment && m_bytesReceived >= ChunkEnd (m_chunksReceived))
+        {
+          ChunkReceivedHandle ();
+        }
+      if (m_bytesReceived == m_videoData->segmentSize.at (m_currentRepIndex).at (m_playbackData.firstSegmentIndex + m_segmentCounter))
         {
+          m_transmissionEndReceivingSegment = Simulator::Now ().GetMicroSeconds ();
           SegmentReceivedHandle ();
         }
     }
 }
 
-int
-TcpStreamClient::ReadInBitrateValues (std::string segmentSizeFile)
+void
+TcpStreamClient::FluidTransmissionStart ()
+{
+  NS_LOG_FUNCTION (this);
+  m_transmissionStartReceivingSegment = Simulator::Now ().GetMicroSeconds ();
+}
+
+void
+TcpStreamClient::FluidTransmissionEnd ()
+{
+  NS_LOG_FUNCTION (this);
+  if (state == terminal)
+    {
+      // the client left during the download
+      return;
+    }
+  m_transmissionEndReceivingSegment = Simulator::Now ().GetMicroSeconds ();
+  LogThroughput (m_videoData->segmentSize.at (m_currentRepIndex).at (m_playbackData.firstSegmentIndex + m_segmentCounter));
+  SegmentReceivedHandle ();
+}
+
+void
+TcpStreamClient::ReadHints (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  uint32_t toCopy = std::min (packet->GetSize (), (uint32_t)(serverHintsSize - m_bytesReceived));
+  packet->CopyData (m_hintBuffer + m_bytesReceived, toCopy);
+  if (m_bytesReceived + toCopy < serverHintsSize)
+    {
+      return;
+    }
+  m_hintBuffer [serverHintsSize - 1] = 0;
+  if (strncmp ((char *) m_hintBuffer, "SAND ", 5) != 0)
+    {
+      return;
+    }
+  std::istringstream hints ((char *) m_hintBuffer + 5);
+  int64_t activeConnections;
+  double fairShare;
+  double egressRate;
+  if (hints >> activeConnections >> fairShare >> egressRate)
+    {
+      m_serverHints.timeReceived.push_back (Simulator::Now ().GetMicroSeconds ());
+      m_serverHints.activeConnections.push_back (activeConnections);
+      m_serverHints.fairShare.push_back (fairShare);
+      m_serverHints.egressRate.push_back (egressRate);
+    }
+}
+
+void
+TcpStreamClient::HandleSegmentStream (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  while (packet->GetSize () > 0)
+    {
+      if (m_bytesReceived == 0)
+        {
+          m_transmissionStartReceivingSegment = Simulator::Now ().GetMicroSeconds ();
+          if (!m_push)
+            {
+              NS_ASSERT_MSG (!m_batchSegments.empty (), "Received data that was not requested");
+              m_receivingSegmentIndex = m_batchSegments.front ().first;
+              m_receivingRepIndex = m_batchSegments.front ().second;
+              m_batchSegments.pop_front ();
+              m_receivingSegmentSize = m_videoData->segmentSize.at (m_receivingRepIndex).at (m_receivingSegmentIndex);
+              m_receivingRequested = std::max (m_lastSegmentEnd, m_firstChunkReleased);
+            }
+        }
+      uint32_t headerSize = m_push ? pushHeaderSize : 0;
+      if (m_bytesReceived < headerSize)
+        {
+          uint32_t toCopy = std::min (packet->GetSize (), (uint32_t)(pushHeaderSize - m_bytesReceived));
+          packet->CopyData (m_pushHeader + m_bytesReceived, toCopy);
+          packet->RemoveAtStart (toCopy);
+          m_bytesReceived += toCopy;
+          if (m_bytesReceived == pushHeaderSize)
+            {
+              ReadPushHeader ();
+            }
+        }
+      else
+        {
+          uint32_t toConsume = std::min ((int64_t) packet->GetSize (), m_receivingSegmentSize - m_bytesReceived);
+          packet->RemoveAtStart (toConsume);
+          m_bytesReceived += toConsume;
+        }
+      if (m_bytesReceived < headerSize)
+        {
+          continue;
+        }
+      while (m_chunksReceived < m_chunksPerSegment && m_bytesReceived >= ChunkEnd (m_chunksReceived))
+        {
+          ChunkReceivedHandle ();
+        }
+      if (m_bytesReceived == m_receivingSegmentSize)
+        {
+          receivedSegment segment;
+          segment.segmentIndex = m_receivingSegmentIndex;
+          segment.repIndex = m_receivingRepIndex;
+          segment.transmissionRequested = m_receivingRequested;
+          segment.transmissionStart = m_transmissionStartReceivingSegment;
+          segment.transmissionEnd = Simulator::Now ().GetMicroSeconds ();
+          segment.transmissionIdle = m_transmissionIdle;
+          m_receivedAhead.push_back (segment);
+          m_lastSegmentEnd = segment.transmissionEnd;
+          m_bytesReceived = 0;
+          m_chunksReceived = 0;
+          m_transmissionIdle = 0;
+          if (m_waitingForSegment)
+            {
+              DeliverReceivedSegment ();
+            }
+        }
+    }
+}
+
+void
+TcpStreamClient::ReadPushHeader ()
+{
+  NS_LOG_FUNCTION (this);
+  m_pushHeader [pushHeaderSize - 1] = 0;
+  std::istringstream header ((char *) m_pushHeader);
+  std::string tag;
+  header >> tag >> m_receivingSegmentIndex >> m_receivingRepIndex;
+  NS_ASSERT_MSG (tag == "PUSH", "Pushed segment does not start with a push header");
+  m_receivingSegmentSize = m_videoData->segmentSize.at (m_receivingRepIndex).at (m_receivingSegmentIndex);
+  m_firstChunkReleased = m_live ? SegmentAvailabilityTime (m_receivingSegmentIndex) : 0;
+  m_receivingRequested = std::max (m_lastSegmentEnd, m_firstChunkReleased);
+}
+
+void
+TcpStreamClient::RequestPushedSegment ()
+{
+  NS_LOG_FUNCTION (this);
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  if (!m_pushSubscribed)
+    {
+      int64_t segmentIndex = m_playbackData.firstSegmentIndex + m_segmentCounter;
+      std::ostringstream subscription;
+      subscription << "PUSH " << m_videoId << " " << m_currentRepIndex << " " << segmentIndex << " "
+                   << m_playbackData.firstSegmentIndex + m_lastSegmentIndex << " " << m_chunksPerSegment << " "
+                   << (m_live ? SegmentAvailabilityTime (segmentIndex) : 0) << " " << m_videoData->segmentDuration / m_chunksPerSegment;
+      std::string message = subscription.str ();
+      Send (message);
+      m_pushSubscribed = true;
+      m_pushRepIndex = m_currentRepIndex;
+      m_lastSegmentEnd = timeNow;
+    }
+  else
+    {
+      if (m_currentRepIndex != m_pushRepIndex)
+        {
+          std::string message = "REP " + ToString (m_currentRepIndex);
+          Send (message);
+          m_pushRepIndex = m_currentRepIndex;
+        }
+      if (m_pushPaused)
+        {
+          std::string message = "RESUME";
+          Send (message);
+          m_pushPaused = false;
+          m_lastSegmentEnd = std::max (m_lastSegmentEnd, timeNow);
+        }
+    }
+  WaitForSegment ();
+}
+
+void
+TcpStreamClient::WaitForSegment ()
 {
   NS_LOG_FUNCTION (this);
-  std::ifstream myfile;
-  myfile.open (segmentSizeFile.c_str ());
-  if (!myfile)
+  m_waitingForSegment = true;
+  if (!m_receivedAhead.empty ())
+    {
+      m_scheduledEvents++;
+      DASH_PROFILE_COUNT ("Schedule DeliverReceivedSegment");
+      Simulator::ScheduleNow (&TcpStreamClient::DeliverReceivedSegment, this);
+    }
+}
+
+bool
+TcpStreamClient::ReceivesSegmentStream () const
+{
+  return m_push || m_batchSize > 1;
+}
+
+int64_t
+TcpStreamClient::BatchLength (int64_t segmentIndex) const
+{
+  if (m_bufferData.bufferLevelNew.empty ())
     {
-      return -1;
+      return 1;
     }
-  std::string temp;
-  int64_t averageByteSizeTemp = 0;
-  while (std::getline (myfile, temp))
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  int64_t bufferNow = m_bufferData.bufferLevelNew.back () - (timeNow - m_throughput.transmissionEnd.back ());
+  if (bufferNow < m_batchThreshold.GetMicroSeconds ())
     {
-      if (temp.empty ())
+      return 1;
+    }
+  int64_t lastIndex = m_playbackData.firstSegmentIndex + m_lastSegmentIndex;
+  int64_t batch = 1;
+  while (batch < m_batchSize && segmentIndex + batch <= lastIndex)
+    {
+      int64_t encoded = SegmentAvailabilityTime (segmentIndex + batch) + m_videoData->segmentDuration - m_videoData->segmentDuration / m_chunksPerSegment;
+      if (m_live && encoded > timeNow)
         {
           break;
         }
-      std::istringstream buffer (temp);
-      std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
-                                 std::istream_iterator<int64_t>());
-      m_videoData.segmentSize.push_back (line);
-      averageByteSizeTemp = (int64_t) std::accumulate ( line.begin (), line.end (), 0.0) / line.size ();
-      m_videoData.averageBitrate.push_back ((8.0 * averageByteSizeTemp) / (m_videoData.segmentDuration / 1000000.0));
+      batch++;
     }
-  NS_ASSERT_MSG (!m_videoData.segmentSize.empty (), "No segment sizes read from file.");
-  return 1;
+  return batch;
 }
 
 void
-TcpStreamClient::SegmentReceivedHandle ()
+TcpStreamClient::DeliverReceivedSegment ()
 {
   NS_LOG_FUNCTION (this);
-  m_transmissionEndReceivingSegment = Simulator::Now ().GetMicroSeconds ();
+  if (state == terminal || !m_waitingForSegment || m_receivedAhead.empty ())
+    {
+      return;
+    }
+  m_waitingForSegment = false;
+  receivedSegment segment = m_receivedAhead.front ();
+  m_receivedAhead.pop_front ();
+  NS_ASSERT_MSG (segment.segmentIndex == m_playbackData.firstSegmentIndex + m_segmentCounter, "Segments were pushed out of order");
+  m_currentRepIndex = segment.repIndex;
+  m_playbackData.playbackIndex.at (m_segmentCounter) = segment.repIndex;
+  // the next segment may be arriving already, keep its values
+  int64_t receivingStart = m_transmissionStartReceivingSegment;
+  int64_t receivingIdle = m_transmissionIdle;
+  m_downloadRequestSent = segment.transmissionRequested;
+  m_transmissionStartReceivingSegment = segment.transmissionStart;
+  m_transmissionEndReceivingSegment = segment.transmissionEnd;
+  m_transmissionIdle = segment.transmissionIdle;
+  SegmentReceivedHandle ();
+  m_transmissionStartReceivingSegment = receivingStart;
+  m_transmissionIdle = receivingIdle;
+}
 
+void
+TcpStreamClient::SegmentReceivedHandle ()
+{
+  NS_LOG_FUNCTION (this);
 
   m_bufferData.timeNow.push_back (m_transmissionEndReceivingSegment);
   if (m_segmentCounter > 0)
@@ -379,25 +828,37 @@ TcpStreamClient::SegmentReceivedHandle ()
     {
       m_bufferData.bufferLevelOld.push_back (0);
     }
-  m_bufferData.bufferLevelNew.push_back (m_bufferData.bufferLevelOld.back () + m_videoData.segmentDuration);
+  m_bufferData.bufferLevelNew.push_back (m_bufferData.bufferLevelOld.back () + m_videoData->segmentDuration);
 
-  m_throughput.bytesReceived.push_back (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
+  m_throughput.bytesReceived.push_back (m_videoData->segmentSize.at (m_currentRepIndex).at (m_playbackData.firstSegmentIndex + m_segmentCounter));
   m_throughput.transmissionStart.push_back (m_transmissionStartReceivingSegment);
   m_throughput.transmissionRequested.push_back (m_downloadRequestSent);
   m_throughput.transmissionEnd.push_back (m_transmissionEndReceivingSegment);
+  m_throughput.transmissionIdle.push_back (m_transmissionIdle);
 
   LogDownload ();
 
   LogBuffer ();
 
-  m_segmentsInBuffer++;
-  m_bytesReceived = 0;
+  if (!m_candidates.empty ())
+    {
+      UpdateServerStatistics ();
+    }
+
+  if (!ReceivesSegmentStream ())
+    {
+      // pushed or batched data of the following segments may have arrived already
+      m_bytesReceived = 0;
+      m_chunksReceived = 0;
+      m_transmissionIdle = 0;
+    }
   if (m_segmentCounter == m_lastSegmentIndex)
     {
       m_bDelay = 0;
     }
 
   controllerEvent event = downloadFinished;
+  DASH_PROFILE_COUNT ("Direct downloadFinished");
   Controller (event);
 
 }
@@ -408,14 +869,15 @@ TcpStreamClient::PlaybackHandle ()
   NS_LOG_FUNCTION (this);
   int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
   // if we got called and there are no segments left in the buffer, there is a buffer underrun
-  if (m_segmentsInBuffer == 0 && m_currentPlaybackIndex < m_lastSegmentIndex && !m_bufferUnderrun)
+  if (m_chunksInBuffer == 0 && m_currentPlaybackIndex < m_lastSegmentIndex && !m_bufferUnderrun)
     {
       m_bufferUnderrun = true;
+      m_playbackRate = 1;
       bufferUnderrunLog << std::setfill (' ') << std::setw (26) << timeNow / (double)1000000 << " ";
       bufferUnderrunLog.flush ();
       return true;
     }
-  else if (m_segmentsInBuffer > 0)
+  else if (m_chunksInBuffer > 0)
     {
       if (m_bufferUnderrun)
         {
@@ -423,16 +885,111 @@ TcpStreamClient::PlaybackHandle ()
           bufferUnderrunLog << std::setfill (' ') << std::setw (13) << timeNow / (double)1000000 << "\n";
           bufferUnderrunLog.flush ();
         }
-      m_playbackData.playbackStart.push_back (timeNow);
-      LogPlayback ();
-      m_segmentsInBuffer--;
-      m_currentPlaybackIndex++;
+      m_chunksInBuffer--;
+      if (m_playbackChunk == 0)
+        {
+          m_playbackData.playbackStart.push_back (timeNow);
+          LogPlayback ();
+          if (m_live)
+            {
+              int64_t latency = timeNow - (m_availabilityStartTime.GetMicroSeconds ()
+                                           + (m_playbackData.firstSegmentIndex + m_currentPlaybackIndex) * m_videoData->segmentDuration);
+              AdjustPlaybackRate (latency);
+              LogLiveLatency (latency);
+              m_liveLatencyTrace (MicroSeconds (latency), m_playbackRate);
+            }
+        }
+      m_playbackChunk++;
+      if (m_playbackChunk == m_chunksPerSegment)
+        {
+          m_playbackChunk = 0;
+          m_currentPlaybackIndex++;
+        }
       return false;
     }
 
   return true;
 }
 
+int64_t
+TcpStreamClient::PlaybackDuration () const
+{
+  return (int64_t)(m_videoData->segmentDuration / m_chunksPerSegment / m_playbackRate);
+}
+
+int64_t
+TcpStreamClient::SegmentAvailabilityTime (int64_t segmentIndex) const
+{
+  return m_availabilityStartTime.GetMicroSeconds () + segmentIndex * m_videoData->segmentDuration + m_videoData->segmentDuration / m_chunksPerSegment;
+}
+
+int64_t
+TcpStreamClient::ChunkEnd (int64_t chunk) const
+{
+  return (m_receivingSegmentSize * (chunk + 1)) / m_chunksPerSegment;
+}
+
+void
+TcpStreamClient::ChunkReceivedHandle ()
+{
+  NS_LOG_FUNCTION (this);
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  if (m_chunksReceived > 0)
+    {
+      // time between the previous chunk and the encoding of this one is not spent transmitting
+      int64_t released = m_firstChunkReleased + m_chunksReceived * (m_videoData->segmentDuration / m_chunksPerSegment);
+      m_transmissionIdle += std::max (released - m_lastChunkEnd, (int64_t)0);
+    }
+  m_lastChunkEnd = timeNow;
+  m_chunksReceived++;
+  m_chunksInBuffer++;
+  if (m_chunksPerSegment > 1 && state == downloading)
+    {
+      controllerEvent event = chunkReceived;
+      Controller (event);
+    }
+}
+
+bool
+TcpStreamClient::JoinLiveStream ()
+{
+  NS_LOG_FUNCTION (this);
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  if (timeNow < SegmentAvailabilityTime (0))
+    {
+      controllerEvent event = init;
+      m_scheduledEvents++;
+      DASH_PROFILE_COUNT ("Schedule init");
+      Simulator::Schedule (MicroSeconds (SegmentAvailabilityTime (0) - timeNow), &TcpStreamClient::Controller, this, event);
+      return false;
+    }
+  int64_t liveEdge = (timeNow - m_availabilityStartTime.GetMicroSeconds () - m_videoData->segmentDuration / m_chunksPerSegment) / m_videoData->segmentDuration;
+  int64_t numberOfSegments = m_videoData->segmentSize.at (0).size ();
+  if (liveEdge >= numberOfSegments - 1)
+    {
+      NS_LOG_LOGIC ("Tcp Stream Client joined a live stream that is over already");
+      state = terminal;
+      StopApplication ();
+      return false;
+    }
+  m_playbackData.firstSegmentIndex = liveEdge;
+  m_lastSegmentIndex = numberOfSegments - 1 - liveEdge;
+  return true;
+}
+
+void
+TcpStreamClient::AdjustPlaybackRate (int64_t latency)
+{
+  NS_LOG_FUNCTION (this << latency);
+  double deviation = (latency - m_targetLatency.GetMicroSeconds ()) / (double) m_targetLatency.GetMicroSeconds ();
+  m_playbackRate = 1 + std::max (-m_maxPlaybackRateChange, std::min (m_maxPlaybackRateChange, deviation));
+  if (m_chunksInBuffer == 0 && m_playbackRate > 1)
+    {
+      // catching up with an empty buffer would only bring the next stall closer
+      m_playbackRate = 1;
+    }
+}
+
 void
 TcpStreamClient::SetRemote (Address ip, uint16_t port)
 {
@@ -457,6 +1014,98 @@ TcpStreamClient::SetRemote (Ipv6Address ip, uint16_t port)
   m_peerPort = port;
 }
 
+void
+TcpStreamClient::SetServerSelector (Callback<Address, uint32_t> selector)
+{
+  NS_LOG_FUNCTION (this);
+  m_serverSelector = selector;
+}
+
+void
+TcpStreamClient::SetFluidNetwork (Ptr<FluidNetwork> network, uint32_t path)
+{
+  NS_LOG_FUNCTION (this << network << path);
+  m_fluidNetwork = network;
+  m_fluidPath = path;
+}
+
+void
+TcpStreamClient::AddCandidateServer (Address ip, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << ip << port);
+  candidateServer server;
+  server.address = ip;
+  server.port = port;
+  server.throughput = 0;
+  server.rtt = 0;
+  server.samples = 0;
+  m_candidates.push_back (server);
+}
+
+bool
+TcpStreamClient::SwitchServer ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_switching || m_candidates.size () < 2 || m_segmentsSinceSwitch < m_minSegmentsBetweenSwitches)
+    {
+      return false;
+    }
+  // servers we did not download from yet are assumed to perform like the best server observed so far
+  uint32_t best = m_currentServer;
+  double bestThroughput = (1 + m_switchMargin) * m_candidates.at (m_currentServer).throughput;
+  for (uint32_t i = 0; i < m_candidates.size (); i++)
+    {
+      double throughput = m_candidates.at (i).samples > 0 ? m_candidates.at (i).throughput : m_bestServerThroughput;
+      if (i != m_currentServer && throughput > bestThroughput)
+        {
+          best = i;
+          bestThroughput = throughput;
+        }
+    }
+  if (best == m_currentServer)
+    {
+      return false;
+    }
+  LogServerSwitch (m_currentServer, best);
+  m_oldSocket = m_socket;
+  m_previousServer = m_currentServer;
+  m_currentServer = best;
+  SetRemote (m_candidates.at (best).address, m_candidates.at (best).port);
+  m_socket = Connect (m_peerAddress, m_peerPort);
+  m_switching = true;
+  m_segmentsSinceSwitch = 0;
+  return true;
+}
+
+void
+TcpStreamClient::UpdateServerStatistics ()
+{
+  NS_LOG_FUNCTION (this);
+  candidateServer & server = m_candidates.at (m_currentServer);
+  double throughput = (8.0 * m_throughput.bytesReceived.back ()) / ((m_transmissionEndReceivingSegment - m_requestSentToServer - m_throughput.transmissionIdle.back ()) / 1000000.0);
+  double rtt = m_transmissionStartReceivingSegment - m_requestSentToServer;
+  if (server.samples == 0)
+    {
+      server.throughput = throughput;
+      server.rtt = rtt;
+    }
+  else
+    {
+      server.throughput = m_serverStatsSmoothing * throughput + (1 - m_serverStatsSmoothing) * server.throughput;
+      server.rtt = m_serverStatsSmoothing * rtt + (1 - m_serverStatsSmoothing) * server.rtt;
+    }
+  server.samples++;
+  m_bestServerThroughput = std::max (m_bestServerThroughput, server.throughput);
+  m_segmentsSinceSwitch++;
+  // the first segment from the new server has arrived, so the connection to the old one is not needed anymore
+  if (m_oldSocket != 0)
+    {
+      m_oldSocket->Close ();
+      m_oldSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_oldSocket = 0;
+    }
+}
+
 void
 TcpStreamClient::DoDispose (void)
 {
@@ -468,29 +1117,71 @@ void
 TcpStreamClient::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
-  if (m_socket == 0)
+  m_applicationStart = Simulator::Now ().GetMicroSeconds ();
+  if (!m_serverSelector.IsNull ())
     {
-      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
-      m_socket = Socket::CreateSocket (GetNode (), tid);
-      if (Ipv4Address::IsMatchingType (m_peerAddress) == true)
+      Address server = m_serverSelector (m_clientId);
+      if (InetSocketAddress::IsMatchingType (server))
         {
-          m_socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom (m_peerAddress), m_peerPort));
+          SetRemote (InetSocketAddress::ConvertFrom (server).GetIpv4 (), InetSocketAddress::ConvertFrom (server).GetPort ());
         }
-      else if (Ipv6Address::IsMatchingType (m_peerAddress) == true)
+      else if (Inet6SocketAddress::IsMatchingType (server))
         {
-          m_socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom (m_peerAddress), m_peerPort));
+          SetRemote (Inet6SocketAddress::ConvertFrom (server).GetIpv6 (), Inet6SocketAddress::ConvertFrom (server).GetPort ());
         }
-      m_socket->SetConnectCallback (
-        MakeCallback (&TcpStreamClient::ConnectionSucceeded, this),
-        MakeCallback (&TcpStreamClient::ConnectionFailed, this));
-      m_socket->SetRecvCallback (MakeCallback (&TcpStreamClient::HandleRead, this));
     }
+  if (!m_candidates.empty ())
+    {
+      m_currentServer = m_clientId % m_candidates.size ();
+      SetRemote (m_candidates.at (m_currentServer).address, m_candidates.at (m_currentServer).port);
+      std::string sLog = dashLogDirectory + m_algoName + "/" +  ToString (m_numberOfClients)  + "/sim" + ToString (m_simulationId) + "_" + "cl" + ToString (m_clientId) + "_"  + "serverSwitchLog.txt";
+      serverSwitchLog.open (sLog.c_str ());
+      NS_ABORT_MSG_IF (!serverSwitchLog.is_open (), "Couldn't open the log file " << sLog << ", check the log directory and the limit of open files");
+      serverSwitchLog << "     Time_Now Segment_Index From   To From_Throughput To_Throughput From_RTT To_RTT\n";
+      serverSwitchLog.flush ();
+    }
+  if (m_fluidNetwork != 0)
+    {
+      NS_ABORT_MSG_IF (m_push || m_chunksPerSegment > 1 || m_batchSize > 1 || !m_candidates.empty (),
+                       "Pushed, chunked or batched delivery and server switching can not be combined with a fluid network");
+      // there is no connection to set up
+      controllerEvent event = init;
+      Controller (event);
+      return;
+    }
+  if (m_socket == 0)
+    {
+      m_socket = Connect (m_peerAddress, m_peerPort);
+    }
+}
+
+Ptr<Socket>
+TcpStreamClient::Connect (Address ip, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << ip << port);
+  TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+  Ptr<Socket> socket = Socket::CreateSocket (GetNode (), tid);
+  if (Ipv4Address::IsMatchingType (ip) == true)
+    {
+      socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom (ip), port));
+    }
+  else if (Ipv6Address::IsMatchingType (ip) == true)
+    {
+      socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom (ip), port));
+    }
+  socket->SetConnectCallback (
+    MakeCallback (&TcpStreamClient::ConnectionSucceeded, this),
+    MakeCallback (&TcpStreamClient::ConnectionFailed, this));
+  socket->SetRecvCallback (MakeCallback (&TcpStreamClient::HandleRead, this));
+  return socket;
 }
 
 void
 TcpStreamClient::StopApplication ()
 {
   NS_LOG_FUNCTION (this);
+  // a client stopped in the middle of its session leaves, events scheduled before are ignored from now on
+  state = terminal;
 
   if (m_socket != 0)
     {
@@ -498,12 +1189,27 @@ TcpStreamClient::StopApplication ()
       m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
       m_socket = 0;
     }
+  if (m_oldSocket != 0)
+    {
+      m_oldSocket->Close ();
+      m_oldSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_oldSocket = 0;
+    }
+  if (!m_sessionFinished)
+    {
+      m_sessionFinished = true;
+      LogSession ();
+      sessionLog.close ();
+      m_sessionFinishedTrace (m_clientId);
+    }
   downloadLog.close ();
   playbackLog.close ();
   adaptationLog.close ();
   bufferLog.close ();
   throughputLog.close ();
   bufferUnderrunLog.close ();
+  serverSwitchLog.close ();
+  liveLatencyLog.close ();
 }
 
 
@@ -531,6 +1237,14 @@ TcpStreamClient::ConnectionSucceeded (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
   NS_LOG_LOGIC ("Tcp Stream Client connection succeeded");
+  if (m_switching)
+    {
+      m_switching = false;
+      m_scheduledEvents++;
+      DASH_PROFILE_COUNT ("Schedule SendSegmentRequest");
+      Simulator::Schedule (m_switchDelay, &TcpStreamClient::SendSegmentRequest, this);
+      return;
+    }
   controllerEvent event = init;
   Controller (event);
 }
@@ -540,12 +1254,31 @@ TcpStreamClient::ConnectionFailed (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
   NS_LOG_LOGIC ("Tcp Stream Client connection failed");
+  if (!m_switching || state == terminal)
+    {
+      return;
+    }
+  // stay with the previous server, whose connection is still open, and never pick the unreachable one again
+  candidateServer & failed = m_candidates.at (m_currentServer);
+  failed.throughput = 0;
+  failed.samples = std::max (failed.samples, (int64_t) 1);
+  LogServerSwitch (m_currentServer, m_previousServer);
+  m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  m_socket = m_oldSocket;
+  m_oldSocket = 0;
+  m_currentServer = m_previousServer;
+  SetRemote (m_candidates.at (m_currentServer).address, m_candidates.at (m_currentServer).port);
+  m_switching = false;
+  m_scheduledEvents++;
+  DASH_PROFILE_COUNT ("Schedule SendSegmentRequest");
+  Simulator::ScheduleNow (&TcpStreamClient::SendSegmentRequest, this);
 }
 
 void
 TcpStreamClient::LogThroughput (uint32_t packetSize)
 {
   NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::LogThroughput");
   throughputLog << std::setfill (' ') << std::setw (13) << Simulator::Now ().GetMicroSeconds ()  / (double) 1000000 << " "
                 << std::setfill (' ') << std::setw (13) << packetSize << "\n";
   throughputLog.flush ();
@@ -555,11 +1288,12 @@ void
 TcpStreamClient::LogDownload ()
 {
   NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::LogDownload");
   downloadLog << std::setfill (' ') << std::setw (13) << m_segmentCounter << " "
               << std::setfill (' ') << std::setw (21) << m_downloadRequestSent / (double)1000000 << " "
               << std::setfill (' ') << std::setw (14) << m_transmissionStartReceivingSegment / (double)1000000 << " "
               << std::setfill (' ') << std::setw (12) << m_transmissionEndReceivingSegment / (double)1000000 << " "
-              << std::setfill (' ') << std::setw (12) << m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter) << " "
+              << std::setfill (' ') << std::setw (12) << m_videoData->segmentSize.at (m_currentRepIndex).at (m_playbackData.firstSegmentIndex + m_segmentCounter) << " "
               << std::setfill (' ') << std::setw (12) << "Y\n";
   downloadLog.flush ();
 }
@@ -568,6 +1302,7 @@ void
 TcpStreamClient::LogBuffer ()
 {
   NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::LogBuffer");
   bufferLog << std::setfill (' ') << std::setw (13) << m_transmissionEndReceivingSegment / (double)1000000 << " "
             << std::setfill (' ') << std::setw (13) << m_bufferData.bufferLevelOld.back () / (double)1000000 << "\n"
             << std::setfill (' ') << std::setw (13) << m_transmissionEndReceivingSegment / (double)1000000 << " "
@@ -579,6 +1314,7 @@ void
 TcpStreamClient::LogAdaptation (algorithmReply answer)
 {
   NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::LogAdaptation");
   adaptationLog << std::setfill (' ') << std::setw (13) << m_segmentCounter << " "
                 << std::setfill (' ') << std::setw (9) << m_currentRepIndex << " "
                 << std::setfill (' ') << std::setw (22) << answer.decisionTime / (double)1000000 << " "
@@ -591,12 +1327,95 @@ void
 TcpStreamClient::LogPlayback ()
 {
   NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::LogPlayback");
   playbackLog << std::setfill (' ') << std::setw (13) << m_currentPlaybackIndex << " "
               << std::setfill (' ') << std::setw (14) << Simulator::Now ().GetMicroSeconds ()  / (double)1000000 << " "
               << std::setfill (' ') << std::setw (13) << m_playbackData.playbackIndex.at (m_currentPlaybackIndex) << "\n";
   playbackLog.flush ();
 }
 
+void
+TcpStreamClient::LogLiveLatency (int64_t latency)
+{
+  NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::LogLiveLatency");
+  liveLatencyLog << std::setfill (' ') << std::setw (13) << m_playbackData.firstSegmentIndex + m_currentPlaybackIndex << " "
+                 << std::setfill (' ') << std::setw (14) << Simulator::Now ().GetMicroSeconds ()  / (double)1000000 << " "
+                 << std::setfill (' ') << std::setw (7) << latency / (double)1000000 << " "
+                 << std::setfill (' ') << std::setw (13) << m_playbackRate << "\n";
+  liveLatencyLog.flush ();
+}
+
+void
+TcpStreamClient::LogSession ()
+{
+  NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::LogSession");
+  sessionData session = GetSessionData ();
+  sessionLog << std::setfill (' ') << std::setw (13) << session.startupDelay << " "
+             << std::setfill (' ') << std::setw (14) << session.linkIdle << " "
+             << std::setfill (' ') << std::setw (8) << session.segments << " "
+             << std::setfill (' ') << std::setw (18) << session.averageThroughput << " "
+             << std::setfill (' ') << std::setw (8) << session.requests << " "
+             << std::setfill (' ') << std::setw (16) << session.scheduledEvents << " "
+             << std::setfill (' ') << std::setw (15) << session.averageQuality << "\n";
+  sessionLog.flush ();
+}
+
+sessionData
+TcpStreamClient::GetSessionData (void) const
+{
+  NS_LOG_FUNCTION (this);
+  int64_t linkIdle = 0;
+  for (uint i = 0; i < m_throughput.transmissionStart.size (); i++)
+    {
+      linkIdle += m_throughput.transmissionStart.at (i) - m_throughput.transmissionRequested.at (i);
+    }
+  int64_t bytes = std::accumulate (m_throughput.bytesReceived.begin (), m_throughput.bytesReceived.end (), (int64_t)0);
+  int64_t transmissionTime = 0;
+  for (uint i = 0; i < m_throughput.transmissionEnd.size (); i++)
+    {
+      transmissionTime += m_throughput.transmissionEnd.at (i) - m_throughput.transmissionStart.at (i) - m_throughput.transmissionIdle.at (i);
+    }
+  double averageThroughput = transmissionTime > 0 ? (8.0 * bytes) / (transmissionTime / (double)1000000) : 0;
+  double startupDelay = m_playbackData.playbackStart.empty () ? -1 : (m_playbackData.playbackStart.front () - m_applicationStart) / (double)1000000;
+  double averageQuality = -1;
+  if (!m_videoData->segmentQuality.empty () && !m_throughput.transmissionEnd.empty ())
+    {
+      double qualitySum = 0;
+      for (uint i = 0; i < m_throughput.transmissionEnd.size (); i++)
+        {
+          qualitySum += m_videoData->segmentQuality.at (m_playbackData.playbackIndex.at (i)).at (m_playbackData.firstSegmentIndex + i);
+        }
+      averageQuality = qualitySum / m_throughput.transmissionEnd.size ();
+    }
+  sessionData session;
+  session.startupDelay = startupDelay;
+  session.linkIdle = linkIdle / (double)1000000;
+  session.segments = m_throughput.transmissionEnd.size ();
+  session.averageThroughput = averageThroughput;
+  session.requests = m_requestsSent;
+  session.scheduledEvents = m_scheduledEvents;
+  session.averageQuality = averageQuality;
+  return session;
+}
+
+void
+TcpStreamClient::LogServerSwitch (uint32_t from, uint32_t to)
+{
+  NS_LOG_FUNCTION (this);
+  DASH_PROFILE_SCOPE ("TcpStreamClient::LogServerSwitch");
+  serverSwitchLog << std::setfill (' ') << std::setw (13) << Simulator::Now ().GetMicroSeconds ()  / (double)1000000 << " "
+                  << std::setfill (' ') << std::setw (13) << m_segmentCounter << " "
+                  << std::setfill (' ') << std::setw (4) << from << " "
+                  << std::setfill (' ') << std::setw (4) << to << " "
+                  << std::setfill (' ') << std::setw (15) << m_candidates.at (from).throughput << " "
+                  << std::setfill (' ') << std::setw (13) << (m_candidates.at (to).samples > 0 ? m_candidates.at (to).throughput : m_bestServerThroughput) << " "
+                  << std::setfill (' ') << std::setw (8) << m_candidates.at (from).rtt / 1000.0 << " "
+                  << std::setfill (' ') << std::setw (6) << m_candidates.at (to).rtt / 1000.0 << "\n";
+  serverSwitchLog.flush ();
+}
+
 void
 TcpStreamClient::InitializeLogFiles (std::string simulationId, std::string clientId, std::string numberOfClients)
 {
@@ -604,33 +1423,54 @@ TcpStreamClient::InitializeLogFiles (std::string simulationId, std::string clien
 
   std::string dLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "downloadLog.txt";
   downloadLog.open (dLog.c_str ());
+  NS_ABORT_MSG_IF (!downloadLog.is_open (), "Couldn't open the log file " << dLog << ", check the log directory and the limit of open files");
   downloadLog << "Segment_Index Download_Request_Sent Download_Start Download_End Segment_Size Download_OK\n";
   downloadLog.flush ();
 
   std::string pLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "playbackLog.txt";
   playbackLog.open (pLog.c_str ());
+  NS_ABORT_MSG_IF (!playbackLog.is_open (), "Couldn't open the log file " << pLog << ", check the log directory and the limit of open files");
   playbackLog << "Segment_Index Playback_Start Quality_Level\n";
   playbackLog.flush ();
 
   std::string aLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "adaptationLog.txt";
   adaptationLog.open (aLog.c_str ());
+  NS_ABORT_MSG_IF (!adaptationLog.is_open (), "Couldn't open the log file " << aLog << ", check the log directory and the limit of open files");
   adaptationLog << "Segment_Index Rep_Level Decision_Point_Of_Time Case DelayCase\n";
   adaptationLog.flush ();
 
   std::string bLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "bufferLog.txt";
   bufferLog.open (bLog.c_str ());
+  NS_ABORT_MSG_IF (!bufferLog.is_open (), "Couldn't open the log file " << bLog << ", check the log directory and the limit of open files");
   bufferLog << "     Time_Now  Buffer_Level \n";
   bufferLog.flush ();
 
   std::string tLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "throughputLog.txt";
   throughputLog.open (tLog.c_str ());
+  NS_ABORT_MSG_IF (!throughputLog.is_open (), "Couldn't open the log file " << tLog << ", check the log directory and the limit of open files");
   throughputLog << "     Time_Now Bytes Received \n";
   throughputLog.flush ();
 
   std::string buLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "bufferUnderrunLog.txt";
   bufferUnderrunLog.open (buLog.c_str ());
+  NS_ABORT_MSG_IF (!bufferUnderrunLog.is_open (), "Couldn't open the log file " << buLog << ", check the log directory and the limit of open files");
   bufferUnderrunLog << ("Buffer_Underrun_Started_At         Until \n");
   bufferUnderrunLog.flush ();
+
+  std::string sLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "sessionLog.txt";
+  sessionLog.open (sLog.c_str ());
+  NS_ABORT_MSG_IF (!sessionLog.is_open (), "Couldn't open the log file " << sLog << ", check the log directory and the limit of open files");
+  sessionLog << "Startup_Delay Link_Idle_Time Segments Average_Throughput Requests Scheduled_Events Average_Quality\n";
+  sessionLog.flush ();
+
+  if (m_live)
+    {
+      std::string lLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "liveLatencyLog.txt";
+      liveLatencyLog.open (lLog.c_str ());
+      NS_ABORT_MSG_IF (!liveLatencyLog.is_open (), "Couldn't open the log file " << lLog << ", check the log directory and the limit of open files");
+      liveLatencyLog << "Segment_Index Playback_Start Latency Playback_Rate\n";
+      liveLatencyLog.flush ();
+    }
 }
 
 } // Namespace ns3
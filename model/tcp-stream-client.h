@@ -26,11 +26,10 @@
 #include "ns3/traced-callback.h"
 #include <iostream>
 #include <fstream>
+#include <deque>
 #include "tcp-stream-adaptation-algorithm.h"
 #include "tcp-stream-interface.h"
-#include "tobasco2.h"
-#include "festive.h"
-#include "panda.h"
+#include "fluid-network.h"
 
 
 namespace ns3 {
@@ -38,6 +37,33 @@ namespace ns3 {
 class Socket;
 class Packet;
 
+/**
+ * \ingroup tcpStream
+ * \brief data structure the client uses to keep statistics about every server it may download from.
+ */
+struct candidateServer
+{
+  Address address; //!< IP address of the server
+  uint16_t port; //!< port of the server
+  double throughput; //!< smoothed throughput in bits per second of the segments downloaded from this server, including the request's round trip
+  double rtt; //!< smoothed time in microseconds from sending a request to this server until the first byte of the segment arrived
+  int64_t samples; //!< number of segments downloaded from this server
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief data structure the client uses to keep a pushed or batched segment that arrived before the controller asked for it.
+ */
+struct receivedSegment
+{
+  int64_t segmentIndex; //!< index of the segment in the video
+  int64_t repIndex; //!< representation index the server sent the segment in
+  int64_t transmissionRequested; //!< point in time in microseconds the server could start sending the segment, i.e. the request, the end of the previous one or its encoding
+  int64_t transmissionStart; //!< point in time in microseconds the first byte of the segment arrived
+  int64_t transmissionEnd; //!< point in time in microseconds the last byte of the segment arrived
+  int64_t transmissionIdle; //!< time in microseconds the server waited for chunks of the segment to be encoded
+};
+
 /**
  * \ingroup tcpStream
  * \brief A Tcp Stream client
@@ -59,12 +85,12 @@ public:
   /**
    * \brief Set the adaptation algorithm which this client instance should use.
    *
-   * A new adaptation algorithm object is created, by calling a constructor of an existing subclass of
-   * AdaptationAlgorithm.
+   * A new adaptation algorithm object is created by the algorithm registered under the given name,
+   * see AdaptationAlgorithm::Create.
    *
-   * \param algorithm the name of the algorithm to use for instantiating an adaptation algorithm object.
+   * \param algorithm the short or TypeId name of the algorithm to use for instantiating an adaptation algorithm object.
    */
-  void Initialise (std::string algorithm, uint16_t clientId);
+  void Initialise (std::string algorithm, uint32_t clientId);
 
   /**
    * \brief Set the remote address and port
@@ -84,6 +110,64 @@ public:
    * \param port remote port
    */
   void SetRemote (Address ip, uint16_t port);
+  /**
+   * \brief Set a function choosing the server when the application starts.
+   *
+   * The function is called with the client's id and returns the InetSocketAddress or Inet6SocketAddress
+   * of the server to connect to, overriding the remote address and port, e.g. to let a server pool
+   * balance the load of the clients.
+   *
+   * \param selector the function choosing the server.
+   */
+  void SetServerSelector (Callback<Address, uint32_t> selector);
+  /**
+   * \brief Add a server the client may download segments from.
+   *
+   * If candidate servers were added, the client starts with candidate m_clientId modulo the number of candidates,
+   * overriding the remote address and port, and keeps statistics of the throughput and round trip time of
+   * every server it downloads from. Between two segments it switches to another candidate if that one promises
+   * more than m_switchMargin higher throughput than the current one. Candidates that have not been used yet are
+   * assumed to perform like the best server observed so far, so a server whose performance degrades will be left
+   * for an untried one. Switching costs a new TCP connection setup and slow start, plus m_switchDelay.
+   *
+   * \param ip the IP address of the server
+   * \param port the port of the server
+   */
+  void AddCandidateServer (Address ip, uint16_t port);
+  /**
+   * \brief Download the segments as flows of a fluid network instead of over a TCP connection.
+   *
+   * The client then neither opens a socket nor needs an internet stack: every segment request starts a
+   * flow of the segment's size along the given path, and the segment is received when the flow completes.
+   * Controller and adaptation algorithm work as with a TCP connection. Pushed, chunked or batched delivery
+   * and server switching need a connection and can not be combined with a fluid network.
+   *
+   * \param network the fluid network
+   * \param path the index of the path of the network the client downloads along
+   */
+  void SetFluidNetwork (Ptr<FluidNetwork> network, uint32_t path);
+
+  /**
+   * TracedCallback signature for the latency of a live client.
+   *
+   * \param [in] latency the time since the start of the segment starting to play was live
+   * \param [in] playbackRate the rate the segment is played with
+   */
+  typedef void (* LiveLatencyCallback)(Time latency, double playbackRate);
+
+  /**
+   * TracedCallback signature for the end of a streaming session.
+   *
+   * \param [in] clientId the id of the client whose session ended, because the video was over or the client left
+   */
+  typedef void (* SessionFinishedCallback)(uint32_t clientId);
+
+  /**
+   * \brief Summarize the streaming session so far, see LogSession.
+   *
+   * \return startup delay, link idle time, segments, average throughput, requests, scheduled events and average quality
+   */
+  sessionData GetSessionData (void) const;
 
 protected:
   virtual void DoDispose (void);
@@ -103,9 +187,9 @@ private:
    */
   enum controllerEvent
   {
-    downloadFinished, playbackFinished, irdFinished, init
+    downloadFinished, playbackFinished, irdFinished, init, chunkReceived
   };
-  AdaptationAlgorithm *algo;
+  Ptr<AdaptationAlgorithm> algo;
 
   virtual void StartApplication (void);
   virtual void StopApplication (void);
@@ -146,6 +230,34 @@ private:
    */
   template <typename T>
   void Send (T & message);
+  /**
+   * \brief Request the segment m_segmentCounter in representation m_currentRepIndex from the server.
+   *
+   * The request is a string of the form "<segment size> <video id> <representation index> <segment index>".
+   * The server only evaluates the segment size, the other values identify the segment for caches in between.
+   */
+  void RequestSegment ();
+  /**
+   * \brief Send the request for segment m_segmentCounter in representation m_currentRepIndex to the current server.
+   */
+  void SendSegmentRequest ();
+  /**
+   * \brief Create a socket and connect it to the server with the given address and port.
+   */
+  Ptr<Socket> Connect (Address ip, uint16_t port);
+  /**
+   * \brief Decide whether to switch to another candidate server before requesting the next segment.
+   *
+   * If a better candidate is found, a connection to it is initiated and the request is sent as soon as
+   * the connection is established.
+   *
+   * \return true if the client is switching to another server.
+   */
+  bool SwitchServer ();
+  /**
+   * \brief Update the statistics of the current server with the segment that was just downloaded.
+   */
+  void UpdateServerStatistics ();
   /**
    * \brief Handle a packet reception.
    *
@@ -156,12 +268,95 @@ private:
    * \param socket the socket the packet was received to.
    */
   void HandleRead (Ptr<Socket> socket);
+  /**
+   * \brief Read the hint record the server may have put at the start of a segment response.
+   *
+   * Called for the packets carrying the first serverHintsSize bytes of a segment. The bytes are
+   * collected in m_hintBuffer and, once complete, parsed and added to m_serverHints if they
+   * contain a hint record, i.e. if the server was configured to send hints.
+   *
+   * \param packet the packet just received.
+   */
+  void ReadHints (Ptr<Packet> packet);
+  /**
+   * \brief Account data of pushed or batched segments, which may arrive back-to-back within one packet.
+   *
+   * The push header at the start of every pushed segment tells which segment in which representation arrives,
+   * batched segments arrive in the order they were requested in, see m_batchSegments.
+   * Completed segments are queued in m_receivedAhead until the controller asks for them.
+   *
+   * \param packet the packet just received.
+   */
+  void HandleSegmentStream (Ptr<Packet> packet);
+  /**
+   * \brief Parse the push header of the segment that is being received.
+   */
+  void ReadPushHeader ();
+  /**
+   * \brief Ask the server for the next segment in push mode.
+   *
+   * The first call subscribes to the push, later calls only send a "REP" message if the adaptation algorithm
+   * chose a different representation, and "RESUME" if the push was paused. The segment is handed to the
+   * controller as soon as it was received completely.
+   */
+  void RequestPushedSegment ();
+  /**
+   * \brief The number of consecutive segments to request in one request, starting with segmentIndex.
+   *
+   * If batching is enabled and the buffer level is at least m_batchThreshold, up to m_batchSize segments are
+   * requested at once, all at the representation the algorithm chose for the first one. A live client only
+   * batches segments that were encoded completely.
+   *
+   * \param segmentIndex the index in the video of the first segment of the request
+   * \return the number of segments to request
+   */
+  int64_t BatchLength (int64_t segmentIndex) const;
+  /**
+   * \brief Wait for a pushed or batched segment, or hand it to the controller if it was completely received already.
+   */
+  void WaitForSegment ();
+  /**
+   * \return true if segments may arrive back-to-back, i.e. in push or batching mode, see HandleSegmentStream
+   */
+  bool ReceivesSegmentStream () const;
+  /**
+   * \brief Hand the oldest completely received pushed or batched segment to the controller, see SegmentReceivedHandle.
+   *
+   * The algorithm's choice of representation may have reached the server after it started pushing the segment, or
+   * the segment was part of a batch requested at one representation, so the representation the segment was actually
+   * sent in is what gets recorded.
+   */
+  void DeliverReceivedSegment ();
+  /**
+   * \brief Log startup delay and link idle time of the streaming session when the client stops.
+   *
+   * - startup delay in seconds, from the start of the application until the first segment started playing
+   * - link idle time in seconds, the sum over all segments of the time between the segment could be sent
+   *   (request sent or, when pushed, previous segment received) and the arrival of its first byte
+   * - number of segments downloaded
+   * - average throughput in bits per second over all segments, leaving out the idle time waiting for the first byte
+   * - number of requests and control messages sent to the server
+   * - number of events the client scheduled
+   * - average perceptual quality of the downloaded segments, -1 without segment qualities
+   */
+  void LogSession ();
+  /**
+   * \brief Called by the fluid network when the first byte of the requested segment arrived.
+   */
+  void FluidTransmissionStart ();
+  /**
+   * \brief Called by the fluid network when the requested segment arrived completely.
+   */
+  void FluidTransmissionEnd ();
   /**
    * \brief triggered by SetConnectCallback if a connection to a host was established.
    */
   void ConnectionSucceeded (Ptr<Socket> socket);
   /**
    * \brief triggered by SetConnectCallback if a connection to a host could not be established.
+   *
+   * If the connection to a server the client is switching to failed, the client stays with the previous
+   * server and does not switch to the failed one again.
    */
   void ConnectionFailed (Ptr<Socket> socket);
   /**
@@ -170,24 +365,63 @@ private:
    */
   void SegmentReceivedHandle ();
   /**
-   * \brief Read in bitrate values
+   * Called after a chunk of the current segment was completely received. The chunk is added to the buffer,
+   * and the time the server waited for the chunk to be encoded is added to the idle time of the transmission.
+   * With chunked delivery, the first chunk received while the client is not playing starts the playback.
+   */
+  void ChunkReceivedHandle ();
+  /**
+   * \return the number of bytes of the current segment up to and including chunk.
    *
-   * The test bitrate values to be read must be provided in bytes in absolute sizes (not per second!)
-   * as a 2x2 matrix, with spaces separating the segment sizes and newlines for every representation level.
+   * \param chunk the index of the chunk within the current segment
    */
-  int ReadInBitrateValues (std::string segmentSizeFile);
+  int64_t ChunkEnd (int64_t chunk) const;
   /*
    * \brief Controls / simulates playback process
    *
-   * Gets called by a timer, when the simulated playback of a segment is finished.
-   * If m_segmentsInBuffer > 0, then m_segmentsInBuffer is decremented and m_currentPlaybackIndex
-   * is incremented. Also, if there was a buffer underrun before, m_bufferUnderrun is set to false
-   * and the end of a buffer underrun is logged. If m_segmentsInBuffer == 0, a buffer underrun is
+   * Gets called by a timer, when the simulated playback of a chunk is finished.
+   * If m_chunksInBuffer > 0, then m_chunksInBuffer is decremented and, once the last chunk of a segment starts
+   * playing, m_currentPlaybackIndex is incremented. Also, if there was a buffer underrun before, m_bufferUnderrun is set to false
+   * and the end of a buffer underrun is logged. If m_chunksInBuffer == 0, a buffer underrun is
    * registered by writing the event in the bufferUnderrun logfile and m_bufferUnderrun is set to true.
+   * Without chunked delivery, a segment is a single chunk.
    *
    * \return true if there is a buffer underrun
    */
   bool PlaybackHandle ();
+  /*
+   * \brief Duration in microseconds of the playback of the current chunk.
+   *
+   * The chunk duration, stretched or compressed by the playback rate chosen when the segment
+   * started playing. The playback rate is always 1 for video on demand.
+   */
+  int64_t PlaybackDuration () const;
+  /*
+   * \brief Point in time in microseconds when a segment of the live stream becomes available at the server.
+   *
+   * Segment i of the video can be requested once its first chunk is encoded, at availabilityStartTime
+   * + i * segmentDuration + chunkDuration, which is availabilityStartTime + (i+1) * segmentDuration without chunking.
+   *
+   * \param segmentIndex the index of the segment in the video, not in the streaming session
+   */
+  int64_t SegmentAvailabilityTime (int64_t segmentIndex) const;
+  /*
+   * \brief Start the streaming session of a live client at the newest available segment.
+   *
+   * Sets m_playbackData.firstSegmentIndex to the live edge and shortens the session accordingly.
+   *
+   * \return false if no segment is available yet or the live stream is over already
+   */
+  bool JoinLiveStream ();
+  /*
+   * \brief Choose the playback rate of the segment starting to play, so the latency approaches the target.
+   *
+   * The rate is the relative deviation of the current latency from m_targetLatency, clamped to
+   * 1 +/- m_maxPlaybackRateChange. The client does not speed up while its buffer is empty.
+   *
+   * \param latency the current latency to the live edge in microseconds
+   */
+  void AdjustPlaybackRate (int64_t latency);
   /*
    * \brief Request the next representation index from algorithm.
    *
@@ -233,6 +467,16 @@ private:
    * - point in time when playback of above mentioned segment starts
    */
   void LogPlayback ();
+  /*
+   * \brief Log a switch to another server.
+   *
+   * - point in time of the switch
+   * - index of the segment that will be requested from the new server
+   * - index of the old and the new server in the list of candidates
+   * - smoothed throughput of the old and the new server in bits per second
+   * - smoothed round trip time of the old and the new server in milliseconds, 0 if not measured yet
+   */
+  void LogServerSwitch (uint32_t from, uint32_t to);
   /*
    * \brief Log information about adaptation algorithm.
    *
@@ -243,6 +487,15 @@ private:
    * \param answer containing the answer the adaptation algorithm has provided.
    */
   void LogAdaptation (algorithmReply answer);
+  /*
+   * \brief Log the latency to the live edge, whenever a segment starts playing
+   *
+   * - segment index in the video
+   * - point in time when the segment started playing
+   * - latency in seconds, i.e. the time since the start of the segment was live
+   * - playback rate the segment is played with
+   */
+  void LogLiveLatency (int64_t latency);
   /*
    * \brief Open log output files with streams.
    *
@@ -257,15 +510,57 @@ private:
   Ptr<Socket> m_socket; //!< Socket
   Address m_peerAddress; //!< Remote peer address
   uint16_t m_peerPort; //!< Remote peer port
+  Callback<Address, uint32_t> m_serverSelector; //!< Chooses the server at application start, if set
+  std::vector<candidateServer> m_candidates; //!< Servers the client may switch between, empty if the client sticks to one server
+  uint32_t m_currentServer; //!< Index of the candidate server currently downloaded from
+  Ptr<Socket> m_oldSocket; //!< Socket of the previous server, closed as soon as the connection to the new server is established
+  bool m_switching; //!< True while the connection to a new server is being set up
+  uint32_t m_previousServer; //!< Index of the candidate server downloaded from before the current switch
+  int64_t m_segmentsSinceSwitch; //!< Number of segments downloaded since the last switch
+  int64_t m_minSegmentsBetweenSwitches; //!< Minimum number of segments to download from a server before switching again
+  double m_switchMargin; //!< Relative margin by which a candidate has to outperform the current server for a switch
+  double m_serverStatsSmoothing; //!< Weight of the newest segment in the smoothed per server statistics
+  Time m_switchDelay; //!< Additional setup cost of a switch on top of the TCP connection setup, e.g. for a TLS handshake
+  double m_bestServerThroughput; //!< Highest smoothed throughput observed for any server so far
+  int64_t m_requestSentToServer; //!< Point in time in microseconds when the current request was sent to the server
+  Ptr<FluidNetwork> m_fluidNetwork; //!< The fluid network the segments are downloaded over, 0 if they are downloaded over a socket
+  uint32_t m_fluidPath; //!< The path of the fluid network the segments are downloaded along
 
-  uint16_t m_clientId; //!< The Id of this client, for logging purposes
+  uint32_t m_clientId; //!< The Id of this client, for logging purposes
   uint16_t m_simulationId; //!< The Id of this simulation, for logging purposes
-  uint16_t m_numberOfClients; //!< The total number of clients for this simulation, for logging purposes
+  uint32_t m_numberOfClients; //!< The total number of clients for this simulation, for logging purposes
+  uint32_t m_videoId; //!< The Id of the video this client streams
   std::string m_segmentSizeFilePath; //!< The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes
+  std::string m_segmentQualityFilePath; //!< The relative path (from ns-3.x directory) to the file containing the segment qualities, empty if not provided
   std::string m_algoName;//!< Name of the apation algorithm's class which this client will use for the simulation
   bool m_bufferUnderrun; //!< True if there is currently a buffer underrun in the simulated playback
   int64_t m_currentPlaybackIndex; //!< The index of the segment that is currently being played
-  int64_t m_segmentsInBuffer; //!< The number of segments that are currently in the buffer
+  int64_t m_chunksInBuffer; //!< The number of chunks that are currently in the buffer
+  uint32_t m_chunksPerSegment; //!< The number of chunks a segment is split into, 1 without chunked delivery
+  int64_t m_chunksReceived; //!< The number of chunks of the current segment received so far
+  int64_t m_playbackChunk; //!< The index of the next chunk to be played within the segment that is currently being played
+  int64_t m_firstChunkReleased; //!< Point in time in microseconds the first chunk of the requested segment was encoded, 0 for video on demand
+  int64_t m_lastChunkEnd; //!< Point in time in microseconds the last chunk was completely received
+  int64_t m_transmissionIdle; //!< Time in microseconds the server waited for chunks of the current segment to be encoded
+  int64_t m_receivingSegmentSize; //!< The size in bytes of the segment currently being received
+  bool m_push; //!< True if the server pushes the segments after a single subscription
+  bool m_pushSubscribed; //!< True once the client subscribed to the push
+  bool m_pushPaused; //!< True if the client asked the server to pause the push
+  bool m_waitingForSegment; //!< True if the controller asked for a segment that did not arrive completely yet
+  int64_t m_pushRepIndex; //!< The representation index the server pushes segments in
+  int64_t m_receivingSegmentIndex; //!< Index in the video of the pushed or batched segment currently being received
+  int64_t m_receivingRepIndex; //!< Representation index of the pushed or batched segment currently being received
+  int64_t m_receivingRequested; //!< Point in time in microseconds the server could start sending the segment currently being received
+  int64_t m_lastSegmentEnd; //!< Point in time in microseconds the last pushed or batched segment was received, or the push was subscribed to or resumed
+  uint8_t m_pushHeader [pushHeaderSize]; //!< The push header of the segment currently being received
+  std::deque<receivedSegment> m_receivedAhead; //!< Completely received pushed or batched segments the controller did not ask for yet
+  uint32_t m_batchSize; //!< The maximum number of segments requested in one request, 1 disables batching
+  Time m_batchThreshold; //!< The buffer level from which on segments are requested in batches
+  std::deque<std::pair<int64_t, int64_t> > m_batchSegments; //!< Index and representation of the requested segments that did not start arriving yet
+  int64_t m_lastRequestedSegment; //!< Index in the video of the last segment requested, -1 before the first request
+  uint64_t m_requestsSent; //!< The number of requests and control messages sent to the server
+  uint64_t m_scheduledEvents; //!< The number of events the client scheduled
+  int64_t m_applicationStart; //!< Point in time in microseconds the application started
   int64_t m_currentRepIndex; //!< The index of the currently requested segment quality
   int64_t m_lastSegmentIndex;//!< The index of the last segment, i.e. the total number of segments-1
   int64_t m_segmentCounter; //!< The index of the next segment to be downloaded
@@ -275,6 +570,17 @@ private:
   int64_t m_bDelay;  //!< Minimum buffer level in microseconds of playback when the next download must be started
   int64_t m_highestRepIndex; //!< This is the index of the highest representation
   uint64_t m_segmentDuration; //!< The duration of a segment in microseconds
+  bool m_live; //!< True if the video is a live stream, whose segments become available one after the other
+  Time m_availabilityStartTime; //!< Point in time when the live stream started, segment i is available one segment duration after its start
+  Time m_targetLatency; //!< The latency to the live edge the playback rate control aims at
+  double m_maxPlaybackRateChange; //!< The maximum deviation of the playback rate from 1
+  double m_playbackRate; //!< The rate the current segment is played with
+
+  /// Traced callback: the latency to the live edge and the playback rate, whenever a segment starts playing
+  TracedCallback<Time, double> m_liveLatencyTrace;
+  /// Traced callback: the session ended, because the video was over or the client was stopped before
+  TracedCallback<uint32_t> m_sessionFinishedTrace;
+  bool m_sessionFinished; //!< True once the session ended and was reported, whether or not it could be logged
 
   std::ofstream adaptationLog; //!< Output stream for logging adaptation information
   std::ofstream downloadLog; //!< Output stream for logging download information
@@ -282,13 +588,18 @@ private:
   std::ofstream bufferLog; //!< Output stream for logging buffer course
   std::ofstream throughputLog; //!< Output stream for logging throughput information
   std::ofstream bufferUnderrunLog; //!< Output stream for logging starting and ending of buffer underruns
+  std::ofstream serverSwitchLog; //!< Output stream for logging switches between servers
+  std::ofstream liveLatencyLog; //!< Output stream for logging the latency to the live edge
+  std::ofstream sessionLog; //!< Output stream for logging startup delay and link idle time of the session
 
   uint64_t m_downloadRequestSent; //!< Logging the point in time in microseconds when a download request was sent to the server
 
   throughputData m_throughput; //!< Tracking the throughput
   bufferData m_bufferData; //!< Keep track of the buffer level
   playbackData m_playbackData; //!< Tracking the simulated playback of segments
-  videoData m_videoData; //!< Information about segment sizes, average bitrates of representation levels and segment duration in microseconds
+  const videoData *m_videoData; //!< Information about segment sizes, average bitrates of representation levels and segment duration in microseconds, shared by all clients streaming the same video
+  serverHints m_serverHints; //!< Hints the server piggybacked on its segment responses
+  uint8_t m_hintBuffer [serverHintsSize]; //!< Collects the first bytes of a segment response, which may contain the server's hints
 
 };
 
@@ -22,6 +22,20 @@ namespace ns3 {
 
 std::string const dashLogDirectory = "dash-log-files/";
 
+/*
+ * Size in bytes of the hint record a server piggybacks at the start of a segment response,
+ * if it was configured to send hints. The record is a zero-terminated string of the form
+ * "SAND <activeConnections> <fairShare> <egressRate>", padded with zeros.
+ */
+uint32_t const serverHintsSize = 64;
+
+/*
+ * Size in bytes of the header a server in push mode starts every pushed segment with, so the client
+ * knows which segment in which representation is arriving. The header is a zero-terminated string of
+ * the form "PUSH <segmentIndex> <repIndex>", padded with zeros, and counts towards the segment size.
+ */
+uint32_t const pushHeaderSize = 32;
+
 /*! \class algorithmReply tcp-stream-interface.h "model/tcp-stream-interface.h"
  *  \ingroup tcpStream
  *  \brief This struct contains the reply an adaptation algorithm returns to the client
@@ -55,6 +69,7 @@ struct throughputData
   std::vector<int64_t> transmissionStart;       //!< Simulation time in microseconds when the first packet of a segment was received
   std::vector<int64_t> transmissionEnd;       //!< Simulation time in microseconds when the last packet of a segment was received
   std::vector<int64_t> bytesReceived;       //!< Number of bytes received, i.e. segment size
+  std::vector<int64_t> transmissionIdle;       //!< Time in microseconds between request and end of the transmission the server had nothing to send, waiting for chunks of a live segment to be encoded
 };
 
 /*! \class bufferData tcp-stream-interface.h "model/tcp-stream-interface.h"
@@ -82,6 +97,7 @@ struct videoData
 {
   std::vector < std::vector<int64_t > > segmentSize;       //!< vector holding representation levels in the first dimension and their particular segment sizes in bytes in the second dimension
   std::vector < double > averageBitrate;       //!< holding the average bitrate of a segment in representation i in bits
+  std::vector < std::vector<double > > segmentQuality;       //!< perceptual quality (e.g. VMAF or SSIM) of every segment, same shape as segmentSize, empty if not provided
   int64_t segmentDuration;       //!< duration of a segment in microseconds
 };
 
@@ -98,6 +114,42 @@ struct playbackData
 {
   std::vector <int64_t> playbackIndex;       //!< Index of the video segment
   std::vector <int64_t> playbackStart; //!< Point in time in microseconds when playback of this segment started
+  int64_t firstSegmentIndex; //!< Index in the video of the first segment of the streaming session, non-zero if a live client joined a running stream
+};
+
+/*! \class serverHints tcp-stream-interface.h "model/tcp-stream-interface.h"
+ *  \ingroup tcpStream
+ *  \brief This is a struct containing the hints the server sent along with the segments.
+ *
+ * Server and network assisted DASH (SAND) style hints, which a server piggybacks on its segment responses
+ * if it is configured to do so. An entry is added for every segment response carrying hints, so the vectors
+ * stay empty if the server does not send any. Adaptation algorithms may use them in addition to their own
+ * throughput measurements, e.g. to converge faster to the bandwidth share available at a shared bottleneck.
+ */
+struct serverHints
+{
+  std::vector<int64_t> timeReceived;       //!< Simulation time in microseconds when the hint was received
+  std::vector<int64_t> activeConnections;       //!< Number of clients connected to the server when the response started
+  std::vector<double> fairShare;       //!< Server's estimate of the fair share of bandwidth per downloading client in bits per second
+  std::vector<double> egressRate;       //!< Aggregate rate in bits per second the server sent data with during its most recent measurement window
+};
+
+/*! \class sessionData tcp-stream-interface.h "model/tcp-stream-interface.h"
+ *  \ingroup tcpStream
+ *  \brief This is a struct containing the summary of a streaming session.
+ *
+ * The values a client writes to its sessionLog file when it stops, also available to the simulation
+ * script, e.g. to aggregate the results of the clients of all ranks of a distributed simulation.
+ */
+struct sessionData
+{
+  double startupDelay;       //!< time in seconds from the start of the application until the first segment started playing, -1 if none did
+  double linkIdle;       //!< time in seconds the client waited for the first byte of its segments
+  int64_t segments;       //!< number of segments downloaded
+  double averageThroughput;       //!< average throughput in bits per second over all segments, leaving out the idle time waiting for the first byte
+  int64_t requests;       //!< number of requests and control messages sent to the server
+  int64_t scheduledEvents;       //!< number of events the client scheduled
+  double averageQuality;       //!< average perceptual quality of the downloaded segments, -1 without segment qualities
 };
 
 } // namespace ns3
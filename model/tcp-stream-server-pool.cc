@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/hash.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "tcp-stream-server-pool.h"
+#include <sstream>
+#include <iomanip>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamServerPool");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamServerPool);
+
+TypeId
+TcpStreamServerPool::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamServerPool")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamServerPool> ()
+    .AddAttribute ("Policy",
+                   "The policy clients are assigned to servers with",
+                   EnumValue (TcpStreamServerPool::ROUND_ROBIN),
+                   MakeEnumAccessor (&TcpStreamServerPool::m_policy),
+                   MakeEnumChecker (TcpStreamServerPool::ROUND_ROBIN, "RoundRobin",
+                                    TcpStreamServerPool::CONSISTENT_HASHING, "ConsistentHashing",
+                                    TcpStreamServerPool::LEAST_CONNECTIONS, "LeastConnections",
+                                    TcpStreamServerPool::WEIGHTED, "Weighted"))
+    .AddAttribute ("VirtualNodes",
+                   "The number of virtual nodes per server on the consistent hashing ring",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&TcpStreamServerPool::m_virtualNodes),
+                   MakeUintegerChecker<uint32_t> (1, 100000))
+  ;
+  return tid;
+}
+
+TcpStreamServerPool::TcpStreamServerPool ()
+{
+  NS_LOG_FUNCTION (this);
+  m_nextServer = 0;
+}
+
+TcpStreamServerPool::~TcpStreamServerPool ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpStreamServerPool::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_servers.clear ();
+  Object::DoDispose ();
+}
+
+void
+TcpStreamServerPool::AddServer (Ptr<TcpStreamServer> server, Address address, uint16_t port, double weight)
+{
+  NS_LOG_FUNCTION (this << server << address << port << weight);
+  NS_ASSERT_MSG (weight > 0, "The weight of a server must be > 0");
+  m_servers.push_back (server);
+  if (Ipv4Address::IsMatchingType (address))
+    {
+      m_addresses.push_back (InetSocketAddress (Ipv4Address::ConvertFrom (address), port));
+    }
+  else
+    {
+      m_addresses.push_back (Inet6SocketAddress (Ipv6Address::ConvertFrom (address), port));
+    }
+  m_weights.push_back (weight);
+  m_currentWeights.push_back (0);
+  m_assignedClients.push_back (0);
+  m_ring.clear ();
+}
+
+Address
+TcpStreamServerPool::SelectServer (uint32_t clientId)
+{
+  NS_LOG_FUNCTION (this << clientId);
+  NS_ASSERT_MSG (!m_servers.empty (), "The server pool is empty");
+  uint32_t chosen = 0;
+  switch (m_policy)
+    {
+    case ROUND_ROBIN:
+      chosen = m_nextServer;
+      m_nextServer = (m_nextServer + 1) % m_servers.size ();
+      break;
+    case CONSISTENT_HASHING:
+      {
+        if (m_ring.empty ())
+          {
+            BuildRing ();
+          }
+        std::ostringstream key;
+        key << "client-" << clientId;
+        std::map<uint32_t, uint32_t>::const_iterator it = m_ring.lower_bound (Hash32 (key.str ()));
+        if (it == m_ring.end ())
+          {
+            it = m_ring.begin ();
+          }
+        chosen = it->second;
+        break;
+      }
+    case LEAST_CONNECTIONS:
+      {
+        // Clients that were assigned but did not connect yet count as well, otherwise clients starting
+        // within a round trip time of each other would all be assigned to the same server.
+        uint64_t fewest = 0;
+        for (uint32_t i = 0; i < m_servers.size (); i++)
+          {
+            uint64_t connections = m_servers.at (i)->GetConnectedClients ()
+              + (m_assignedClients.at (i) - std::min (m_assignedClients.at (i), m_servers.at (i)->GetTotalConnections ()));
+            if (i == 0 || connections < fewest)
+              {
+                fewest = connections;
+                chosen = i;
+              }
+          }
+        break;
+      }
+    case WEIGHTED:
+      {
+        // smooth weighted round robin, spreading the turns of a server evenly instead of in bursts
+        double totalWeight = 0;
+        for (uint32_t i = 0; i < m_servers.size (); i++)
+          {
+            m_currentWeights.at (i) += m_weights.at (i);
+            totalWeight += m_weights.at (i);
+            if (m_currentWeights.at (i) > m_currentWeights.at (chosen))
+              {
+                chosen = i;
+              }
+          }
+        m_currentWeights.at (chosen) -= totalWeight;
+        break;
+      }
+    }
+  m_assignedClients.at (chosen)++;
+  NS_LOG_INFO ("Client " << clientId << " assigned to server " << chosen);
+  return m_addresses.at (chosen);
+}
+
+void
+TcpStreamServerPool::BuildRing (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_servers.size (); i++)
+    {
+      for (uint32_t v = 0; v < m_virtualNodes; v++)
+        {
+          std::ostringstream key;
+          key << "server-" << i << "-" << v;
+          m_ring [Hash32 (key.str ())] = i;
+        }
+    }
+}
+
+void
+TcpStreamServerPool::ReportLoad (std::ostream & os) const
+{
+  uint64_t totalBytes = 0;
+  for (uint32_t i = 0; i < m_servers.size (); i++)
+    {
+      totalBytes += m_servers.at (i)->GetBytesSent ();
+    }
+  os << "Server Weight Assigned_Clients Peak_Clients Requests Bytes_Sent Offered_Load_Mbps Load_Share\n";
+  for (uint32_t i = 0; i < m_servers.size (); i++)
+    {
+      Ptr<TcpStreamServer> server = m_servers.at (i);
+      os << std::setfill (' ') << std::setw (6) << i << " "
+         << std::setfill (' ') << std::setw (6) << m_weights.at (i) << " "
+         << std::setfill (' ') << std::setw (16) << m_assignedClients.at (i) << " "
+         << std::setfill (' ') << std::setw (12) << server->GetPeakConnectedClients () << " "
+         << std::setfill (' ') << std::setw (8) << server->GetRequests () << " "
+         << std::setfill (' ') << std::setw (10) << server->GetBytesSent () << " "
+         << std::setfill (' ') << std::setw (17) << server->GetOfferedLoad () / 1e6 << " "
+         << std::setfill (' ') << std::setw (10) << (totalBytes > 0 ? server->GetBytesSent () / (double) totalBytes : 0.0) << "\n";
+    }
+}
+
+} // namespace ns3
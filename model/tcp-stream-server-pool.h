@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_SERVER_POOL_H
+#define TCP_STREAM_SERVER_POOL_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+#include <map>
+#include <vector>
+#include <ostream>
+#include "tcp-stream-server.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief A pool of Tcp Stream servers, assigning clients to servers according to a load balancing policy.
+ *
+ * Clients ask the pool for their server when they start, see TcpStreamClient::SetServerSelector. The pool
+ * also decides when the streaming sessions are done, which is when none of its servers has clients connected anymore,
+ * and reports the load every server was offered.
+ */
+class TcpStreamServerPool : public Object
+{
+public:
+  /**
+   * \brief The policies the pool can assign clients to servers with.
+   */
+  enum Policy
+  {
+    ROUND_ROBIN,        //!< assign clients to the servers in turn
+    CONSISTENT_HASHING, //!< hash the client id onto a ring of virtual server nodes
+    LEAST_CONNECTIONS,  //!< assign the client to the server with the fewest clients
+    WEIGHTED            //!< assign clients in turn, proportionally to the servers' capacity weights
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  TcpStreamServerPool ();
+  virtual ~TcpStreamServerPool ();
+
+  /**
+   * \brief Add a server to the pool.
+   *
+   * \param server the server application.
+   * \param address the address clients reach the server with.
+   * \param port the port the server listens on.
+   * \param weight the capacity of the server relative to the other servers, used by the weighted policy.
+   */
+  void AddServer (Ptr<TcpStreamServer> server, Address address, uint16_t port, double weight);
+
+  /**
+   * \brief Choose the server for a client according to the configured policy.
+   *
+   * \param clientId the id of the client.
+   * \return the InetSocketAddress or Inet6SocketAddress of the chosen server.
+   */
+  Address SelectServer (uint32_t clientId);
+
+  /**
+   * \brief Print for every server its weight, the number of assigned clients, the peak number of connected clients,
+   * the number of requests and bytes it served, the load it was offered in Mbps and its share of the bytes served by the pool.
+   *
+   * \param os the output stream to print to
+   */
+  void ReportLoad (std::ostream & os) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Build the ring of virtual server nodes used for consistent hashing.
+   */
+  void BuildRing (void);
+
+  Policy m_policy; //!< The policy clients are assigned to servers with
+  uint32_t m_virtualNodes; //!< Number of virtual nodes per server on the consistent hashing ring
+  std::vector<Ptr<TcpStreamServer> > m_servers; //!< The servers of the pool
+  std::vector<Address> m_addresses; //!< The socket addresses of the servers
+  std::vector<double> m_weights; //!< The capacity weights of the servers
+  std::vector<double> m_currentWeights; //!< State of the smooth weighted round robin
+  std::vector<uint64_t> m_assignedClients; //!< The number of clients assigned to every server
+  std::map<uint32_t, uint32_t> m_ring; //!< Consistent hashing ring, mapping hash values to server indices
+  uint32_t m_nextServer; //!< The server the next client is assigned to with round robin
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_SERVER_POOL_H */
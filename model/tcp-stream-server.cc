@@ -29,12 +29,18 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
 #include "ns3/tcp-socket-factory.h"
 #include "tcp-stream-server.h"
 #include "ns3/global-value.h"
 #include <ns3/core-module.h>
 #include "tcp-stream-client.h"
+#include "dash-profiler.h"
 #include "ns3/trace-source-accessor.h"
+#include <fstream>
+#include <iterator>
+#include <cctype>
 
 namespace ns3 {
 
@@ -53,6 +59,26 @@ TcpStreamServer::GetTypeId (void)
                    UintegerValue (9),
                    MakeUintegerAccessor (&TcpStreamServer::m_port),
                    MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("ServerHints",
+                   "If true, the server piggybacks bandwidth hints on the start of every segment response",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpStreamServer::m_sendHints),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HintCapacity",
+                   "Capacity of the bottleneck shared by the clients, used to estimate the fair share. If 0, the measured egress rate is used",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&TcpStreamServer::m_hintCapacity),
+                   MakeDataRateChecker ())
+    .AddAttribute ("HintWindow",
+                   "The duration of the window over which the egress rate is measured",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&TcpStreamServer::m_hintWindow),
+                   MakeTimeChecker ())
+    .AddAttribute ("SegmentSizeFilePath",
+                   "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes, needed to push segments",
+                   StringValue (""),
+                   MakeStringAccessor (&TcpStreamServer::m_segmentSizeFilePath),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -60,6 +86,16 @@ TcpStreamServer::GetTypeId (void)
 TcpStreamServer::TcpStreamServer ()
 {
   NS_LOG_FUNCTION (this);
+  m_activeDownloads = 0;
+  m_windowBytes = 0;
+  m_windowStart = 0;
+  m_egressRate = 0;
+  m_peakConnectedClients = 0;
+  m_totalConnections = 0;
+  m_requests = 0;
+  m_bytesSent = 0;
+  m_firstRequest = 0;
+  m_lastSend = 0;
 }
 
 TcpStreamServer::~TcpStreamServer ()
@@ -80,6 +116,7 @@ void
 TcpStreamServer::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
+  m_windowStart = Simulator::Now ().GetMicroSeconds ();
 
   if (m_socket == 0)
     {
@@ -128,14 +165,38 @@ void
 TcpStreamServer::HandleRead (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
+  DASH_PROFILE_SCOPE ("TcpStreamServer::HandleRead");
   Ptr<Packet> packet;
   Address from;
   packet = socket->RecvFrom (from);
+  uint8_t *buffer = new uint8_t [packet->GetSize ()];
+  packet->CopyData (buffer, packet->GetSize ());
+  std::string content ((char *) buffer, packet->GetSize ());
+  delete [] buffer;
+  if (!content.empty () && isalpha (content [0]))
+    {
+      HandlePushControl (socket, from, content);
+      return;
+    }
   int64_t packetSizeToReturn = GetCommand (packet);
+  if (m_requests == 0)
+    {
+      m_firstRequest = Simulator::Now ().GetMicroSeconds ();
+    }
+  m_requests++;
+  if (!m_callbackData [from].send)
+    {
+      m_activeDownloads++;
+    }
   // these values will be accessible by the clients Address from.
   m_callbackData [from].currentTxBytes = 0;
   m_callbackData [from].packetSizeToReturn = packetSizeToReturn;
   m_callbackData [from].send = true;
+  std::istringstream request (content.c_str ());
+  int64_t size, videoId, repIndex, segmentIndex;
+  int64_t chunks = 1, firstChunkTime = 0, chunkDuration = 0;
+  request >> size >> videoId >> repIndex >> segmentIndex >> chunks >> firstChunkTime >> chunkDuration;
+  ReleaseChunks (socket, from, chunks, firstChunkTime, chunkDuration);
 
   HandleSend (socket, socket->GetTxAvailable ());
 
@@ -144,25 +205,52 @@ TcpStreamServer::HandleRead (Ptr<Socket> socket)
 void
 TcpStreamServer::HandleSend (Ptr<Socket> socket, uint32_t txSpace)
 {
+  DASH_PROFILE_SCOPE ("TcpStreamServer::HandleSend");
   Address from;
   socket->GetPeerName (from);
   // look up values for the connected client and whose values are stored in from
   if (m_callbackData [from].currentTxBytes == m_callbackData [from].packetSizeToReturn)
     {
+      if (m_callbackData [from].send)
+        {
+          m_activeDownloads--;
+        }
       m_callbackData [from].currentTxBytes = 0;
       m_callbackData [from].packetSizeToReturn = 0;
       m_callbackData [from].send = false;
+      m_callbackData [from].releasedBytes = 0;
+      if (m_callbackData [from].push)
+        {
+          m_callbackData [from].nextPushSegment++;
+          PushNextSegment (socket, from);
+        }
       return;
     }
+  if (m_callbackData [from].push && m_callbackData [from].send && m_callbackData [from].currentTxBytes == 0
+      && socket->GetTxAvailable () >= pushHeaderSize)
+    {
+      m_callbackData [from].currentTxBytes += SendPushHeader (socket, from);
+    }
+  if (m_sendHints && !m_callbackData [from].push && m_callbackData [from].send && m_callbackData [from].currentTxBytes == 0
+      && m_callbackData [from].packetSizeToReturn >= serverHintsSize && socket->GetTxAvailable () >= serverHintsSize)
+    {
+      m_callbackData [from].currentTxBytes += SendHints (socket);
+    }
   if (socket->GetTxAvailable () > 0 && m_callbackData [from].send)
     {
       int32_t toSend;
-      toSend = std::min (socket->GetTxAvailable (), m_callbackData [from].packetSizeToReturn - m_callbackData [from].currentTxBytes);
+      if (m_callbackData [from].releasedBytes <= m_callbackData [from].currentTxBytes)
+        {
+          // the next chunk has not been encoded yet, ReleaseChunk resumes sending
+          return;
+        }
+      toSend = std::min (socket->GetTxAvailable (), m_callbackData [from].releasedBytes - m_callbackData [from].currentTxBytes);
       Ptr<Packet> packet = Create<Packet> (toSend);
       int amountSent = socket->Send (packet, 0);
       if (amountSent > 0)
         {
           m_callbackData [from].currentTxBytes += amountSent;
+          UpdateEgressRate (amountSent);
         }
       // We exit this part, when no bytes have been sent, as the send side buffer is full.
       // The "HandleSend" callback will fire when some buffer space has freed up.
@@ -181,37 +269,314 @@ TcpStreamServer::HandleAccept (Ptr<Socket> s, const Address& from)
   cbd.currentTxBytes = 0;
   cbd.packetSizeToReturn = 0;
   cbd.send = false;
+  cbd.releasedBytes = 0;
+  cbd.push = false;
+  cbd.paused = false;
+  cbd.pushRepIndex = 0;
+  cbd.nextPushSegment = 0;
+  cbd.firstPushSegment = 0;
+  cbd.lastPushSegment = 0;
+  cbd.chunks = 1;
+  cbd.firstChunkTime = 0;
+  cbd.chunkDuration = 0;
   m_callbackData [from] = cbd;
   m_connectedClients.push_back (from);
+  m_totalConnections++;
+  m_peakConnectedClients = std::max (m_peakConnectedClients, (uint32_t) m_connectedClients.size ());
   s->SetRecvCallback (MakeCallback (&TcpStreamServer::HandleRead, this));
   s->SetSendCallback ( MakeCallback (&TcpStreamServer::HandleSend, this));
 }
 
 void
 TcpStreamServer::HandlePeerClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  RemoveClient (socket);
+}
+
+void
+TcpStreamServer::HandlePeerError (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  // a client closing while data is still arriving resets the connection
+  RemoveClient (socket);
+}
+
+void
+TcpStreamServer::RemoveClient (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
   Address from;
-  socket->GetPeerName (from);
+  if (socket->GetPeerName (from) != 0)
+    {
+      return;
+    }
+  socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+  std::map <Address, callbackData>::iterator data = m_callbackData.find (from);
+  if (data != m_callbackData.end ())
+    {
+      if (data->second.send)
+        {
+          m_activeDownloads--;
+        }
+      m_callbackData.erase (data);
+    }
   for (std::vector<Address>::iterator it = m_connectedClients.begin (); it != m_connectedClients.end (); ++it)
     {
       if (*it == from)
         {
           m_connectedClients.erase (it);
-          // No more clients left in m_connectedClients, simulation is done.
-          if (m_connectedClients.size () == 0)
+          return;
+        }
+    }
+}
+
+uint32_t
+TcpStreamServer::GetConnectedClients (void) const
+{
+  return m_connectedClients.size ();
+}
+
+uint32_t
+TcpStreamServer::GetPeakConnectedClients (void) const
+{
+  return m_peakConnectedClients;
+}
+
+uint64_t
+TcpStreamServer::GetTotalConnections (void) const
+{
+  return m_totalConnections;
+}
+
+uint64_t
+TcpStreamServer::GetRequests (void) const
+{
+  return m_requests;
+}
+
+uint64_t
+TcpStreamServer::GetBytesSent (void) const
+{
+  return m_bytesSent;
+}
+
+double
+TcpStreamServer::GetOfferedLoad (void) const
+{
+  if (m_lastSend <= m_firstRequest)
+    {
+      return 0;
+    }
+  return (8.0 * m_bytesSent) / ((m_lastSend - m_firstRequest) / 1000000.0);
+}
+
+int
+TcpStreamServer::SendHints (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  double fairShare;
+  if (m_hintCapacity.GetBitRate () > 0)
+    {
+      fairShare = m_hintCapacity.GetBitRate () / (double) std::max (m_activeDownloads, (uint32_t) 1);
+    }
+  else
+    {
+      fairShare = m_egressRate / (double) std::max (m_activeDownloads, (uint32_t) 1);
+    }
+  std::ostringstream ss;
+  ss << "SAND " << m_connectedClients.size () << " " << fairShare << " " << m_egressRate;
+  uint8_t hints [serverHintsSize];
+  memset (hints, 0, serverHintsSize);
+  memcpy (hints, ss.str ().c_str (), std::min ((uint32_t) ss.str ().size (), serverHintsSize - 1));
+  int amountSent = socket->Send (Create<Packet> (hints, serverHintsSize), 0);
+  if (amountSent <= 0)
+    {
+      return 0;
+    }
+  UpdateEgressRate (amountSent);
+  return amountSent;
+}
+
+void
+TcpStreamServer::UpdateEgressRate (uint32_t bytes)
+{
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  m_bytesSent += bytes;
+  m_lastSend = timeNow;
+  m_windowBytes += bytes;
+  if (timeNow - m_windowStart >= m_hintWindow.GetMicroSeconds ())
+    {
+      m_egressRate = (8.0 * m_windowBytes) / ((timeNow - m_windowStart) / 1000000.0);
+      m_windowBytes = 0;
+      m_windowStart = timeNow;
+    }
+}
+
+void
+TcpStreamServer::ReleaseChunks (Ptr<Socket> socket, const Address & from, int64_t chunks, int64_t firstChunkTime, int64_t chunkDuration)
+{
+  NS_LOG_FUNCTION (this << socket << chunks << firstChunkTime << chunkDuration);
+  uint32_t segmentSize = m_callbackData [from].packetSizeToReturn;
+  m_callbackData [from].releasedBytes = segmentSize;
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  // a first chunk time of 0 means video on demand, where every chunk is available already
+  if (chunks < 1 || firstChunkTime <= 0 || (chunks == 1 && firstChunkTime <= timeNow))
+    {
+      return;
+    }
+  m_callbackData [from].releasedBytes = 0;
+  for (int64_t chunk = 0; chunk < chunks; chunk++)
+    {
+      int64_t released = firstChunkTime + chunk * chunkDuration;
+      uint32_t bytes = (uint32_t)((segmentSize * (chunk + 1)) / chunks);
+      if (released <= timeNow)
+        {
+          m_callbackData [from].releasedBytes = bytes;
+        }
+      else
+        {
+          DASH_PROFILE_COUNT ("Schedule ReleaseChunk");
+          Simulator::Schedule (MicroSeconds (released - timeNow), &TcpStreamServer::ReleaseChunk, this, socket, bytes);
+        }
+    }
+}
+
+void
+TcpStreamServer::ReleaseChunk (Ptr<Socket> socket, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << socket << bytes);
+  Address from;
+  socket->GetPeerName (from);
+  // the client may have left since the chunk was scheduled
+  std::map <Address, callbackData>::iterator data = m_callbackData.find (from);
+  if (data == m_callbackData.end () || !data->second.send)
+    {
+      return;
+    }
+  m_callbackData [from].releasedBytes = std::max (m_callbackData [from].releasedBytes, bytes);
+  HandleSend (socket, socket->GetTxAvailable ());
+}
+
+void
+TcpStreamServer::HandlePushControl (Ptr<Socket> socket, const Address & from, std::string messages)
+{
+  NS_LOG_FUNCTION (this << socket);
+  // several control messages may arrive in one packet, each of them is zero-terminated
+  std::istringstream stream (messages);
+  std::string message;
+  while (std::getline (stream, message, '\0'))
+    {
+      std::istringstream fields (message);
+      std::string command;
+      fields >> command;
+      callbackData & cbd = m_callbackData [from];
+      if (command == "PUSH")
+        {
+          if (m_segmentSizes.empty () && !ReadSegmentSizes ())
             {
-              Simulator::Stop ();
+              NS_LOG_ERROR ("Reading the segment sizes for push mode failed, ignoring the subscription.");
+              continue;
+            }
+          int64_t videoId;
+          fields >> videoId >> cbd.pushRepIndex >> cbd.firstPushSegment >> cbd.lastPushSegment
+          >> cbd.chunks >> cbd.firstChunkTime >> cbd.chunkDuration;
+          cbd.push = true;
+          cbd.paused = false;
+          cbd.nextPushSegment = cbd.firstPushSegment;
+          if (!cbd.send)
+            {
+              PushNextSegment (socket, from);
+            }
+        }
+      else if (command == "REP")
+        {
+          fields >> cbd.pushRepIndex;
+        }
+      else if (command == "PAUSE")
+        {
+          cbd.paused = true;
+        }
+      else if (command == "RESUME")
+        {
+          cbd.paused = false;
+          if (cbd.push && !cbd.send)
+            {
+              PushNextSegment (socket, from);
             }
-          return;
         }
     }
 }
 
 void
-TcpStreamServer::HandlePeerError (Ptr<Socket> socket)
+TcpStreamServer::PushNextSegment (Ptr<Socket> socket, const Address & from)
+{
+  NS_LOG_FUNCTION (this << socket);
+  callbackData & cbd = m_callbackData [from];
+  if (cbd.paused || cbd.nextPushSegment > cbd.lastPushSegment)
+    {
+      return;
+    }
+  NS_ASSERT_MSG (cbd.pushRepIndex < (int64_t) m_segmentSizes.size ()
+                 && cbd.nextPushSegment < (int64_t) m_segmentSizes.at (cbd.pushRepIndex).size (),
+                 "The pushed segment is not part of the video");
+  if (m_requests == 0)
+    {
+      m_firstRequest = Simulator::Now ().GetMicroSeconds ();
+    }
+  m_requests++;
+  m_activeDownloads++;
+  cbd.currentTxBytes = 0;
+  cbd.packetSizeToReturn = m_segmentSizes.at (cbd.pushRepIndex).at (cbd.nextPushSegment);
+  cbd.send = true;
+  int64_t segmentDuration = cbd.chunks * cbd.chunkDuration;
+  int64_t firstChunkTime = cbd.firstChunkTime > 0 ? cbd.firstChunkTime + (cbd.nextPushSegment - cbd.firstPushSegment) * segmentDuration : 0;
+  ReleaseChunks (socket, from, cbd.chunks, firstChunkTime, cbd.chunkDuration);
+  HandleSend (socket, socket->GetTxAvailable ());
+}
+
+int
+TcpStreamServer::SendPushHeader (Ptr<Socket> socket, const Address & from)
 {
   NS_LOG_FUNCTION (this << socket);
+  std::ostringstream ss;
+  ss << "PUSH " << m_callbackData [from].nextPushSegment << " " << m_callbackData [from].pushRepIndex;
+  uint8_t header [pushHeaderSize];
+  memset (header, 0, pushHeaderSize);
+  memcpy (header, ss.str ().c_str (), std::min ((uint32_t) ss.str ().size (), pushHeaderSize - 1));
+  int amountSent = socket->Send (Create<Packet> (header, pushHeaderSize), 0);
+  if (amountSent <= 0)
+    {
+      return 0;
+    }
+  UpdateEgressRate (amountSent);
+  return amountSent;
+}
+
+bool
+TcpStreamServer::ReadSegmentSizes ()
+{
+  NS_LOG_FUNCTION (this);
+  std::ifstream myfile;
+  myfile.open (m_segmentSizeFilePath.c_str ());
+  if (!myfile)
+    {
+      return false;
+    }
+  std::string temp;
+  while (std::getline (myfile, temp))
+    {
+      if (temp.empty ())
+        {
+          break;
+        }
+      std::istringstream buffer (temp);
+      std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
+                                 std::istream_iterator<int64_t>());
+      m_segmentSizes.push_back (line);
+    }
+  return !m_segmentSizes.empty ();
 }
 
 int64_t
@@ -24,6 +24,7 @@
 #include "ns3/ptr.h"
 #include "ns3/address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/data-rate.h"
 #include <map>
 #include "ns3/random-variable-stream.h"
 
@@ -49,6 +50,16 @@ struct callbackData
   uint32_t currentTxBytes;//!< already sent bytes for this particular segment, set to 0 if sent bytes == packetSizeToReturn, so transmission for this segment is over
   uint32_t packetSizeToReturn;//!< total amount of bytes that have to be returned to the client
   bool send;//!< true as long as there are still bytes left to be sent for the current segment
+  uint32_t releasedBytes;//!< bytes of the current segment that may be sent already, less than packetSizeToReturn while chunks of a live segment are still being encoded
+  bool push;//!< true if the client subscribed to have its segments pushed
+  bool paused;//!< true if the client asked to pause the push after the current segment
+  int64_t pushRepIndex;//!< representation index of the segments pushed next
+  int64_t nextPushSegment;//!< index of the segment pushed next
+  int64_t firstPushSegment;//!< index of the first segment of the subscription
+  int64_t lastPushSegment;//!< index of the last segment to be pushed
+  int64_t chunks;//!< number of chunks every pushed segment is split into
+  int64_t firstChunkTime;//!< point in time in microseconds the first chunk of the first pushed segment is encoded, 0 for video on demand
+  int64_t chunkDuration;//!< duration of a chunk in microseconds
 };
 
 /**
@@ -68,6 +79,16 @@ public:
   TcpStreamServer ();
   virtual ~TcpStreamServer ();
 
+  uint32_t GetConnectedClients (void) const; //!< \return the number of currently connected clients
+  uint32_t GetPeakConnectedClients (void) const; //!< \return the maximum number of clients that were connected at the same time
+  uint64_t GetTotalConnections (void) const; //!< \return the number of connections accepted since the start of the application
+  uint64_t GetRequests (void) const; //!< \return the number of segment requests received
+  uint64_t GetBytesSent (void) const; //!< \return the number of bytes sent to clients
+  /**
+   * \return the average rate in bits per second the server sent data with, between the first request and the last byte sent
+   */
+  double GetOfferedLoad (void) const;
+
 protected:
   virtual void DoDispose (void);
 
@@ -81,7 +102,9 @@ private:
    * This function is called by lower layers. The received packet's content
    * gets deserialized by GetCommand (Ptr<Packet> packet). If the packets content
    * contains a string composed of an int with
-   * value n, then n bytes will be sent back to the sender.
+   * value n, then n bytes will be sent back to the sender. Of the values following n, which identify
+   * the requested segment (see TcpStreamClient::RequestSegment), only the chunking of the segment is used,
+   * see ReleaseChunks. Push subscriptions and their control messages are passed to HandlePushControl.
    *
    * \param socket the socket the packet was received to.
    */
@@ -117,6 +140,12 @@ private:
   void HandlePeerClose (Ptr<Socket> socket);
   void HandlePeerError (Ptr<Socket> socket);
 
+  /**
+   * \brief Forget a client whose connection was closed, also in the middle of a download if it left early.
+   * \param socket the socket of the connection to the client
+   */
+  void RemoveClient (Ptr<Socket> socket);
+
   /**
    * \brief Deserialize what the client has sent us.
    * \param packet the data the client has sent us
@@ -124,11 +153,113 @@ private:
    */
   int64_t GetCommand (Ptr<Packet> packet);
 
+  /**
+   * \brief Determine when the chunks of the requested segment may be sent.
+   *
+   * A request may carry, after size, video, representation and segment index, the number of chunks the segment
+   * is split into, the point in time in microseconds the first chunk is encoded and the chunk duration in microseconds.
+   * Chunk k is released once it has been encoded, at first chunk time + k * chunk duration, chunks whose time has
+   * passed are released right away. A request without chunking or for video on demand releases the whole segment at once.
+   *
+   * \param socket the socket of the client that requested the segment.
+   * \param from the address of the client.
+   * \param chunks the number of chunks the segment is split into.
+   * \param firstChunkTime the point in time in microseconds the first chunk is encoded, 0 for video on demand.
+   * \param chunkDuration the duration of a chunk in microseconds.
+   */
+  void ReleaseChunks (Ptr<Socket> socket, const Address & from, int64_t chunks, int64_t firstChunkTime, int64_t chunkDuration);
+
+  /**
+   * \brief Allow the first bytes of the current segment to be sent and resume sending.
+   *
+   * \param socket the socket of the client.
+   * \param bytes the number of bytes of the segment that may be sent now.
+   */
+  void ReleaseChunk (Ptr<Socket> socket, uint32_t bytes);
+
+  /**
+   * \brief Handle the zero-terminated control messages of a client in push mode.
+   *
+   * - "PUSH <videoId> <repIndex> <firstSegment> <lastSegment> <chunks> <firstChunkTime> <chunkDuration>" subscribes
+   *   the client, the server then pushes segment after segment on the connection, starting with firstSegment.
+   * - "REP <repIndex>" changes the representation of the segments pushed next.
+   * - "PAUSE" stops the push once the current segment is sent.
+   * - "RESUME" continues a paused push.
+   *
+   * \param socket the socket the messages were received on.
+   * \param from the address of the client.
+   * \param messages the content of the received packet.
+   */
+  void HandlePushControl (Ptr<Socket> socket, const Address & from, std::string messages);
+
+  /**
+   * \brief Start sending the next segment of a push subscription.
+   *
+   * Nothing is sent if the push is paused or all segments of the subscription were pushed. The segment starts with a
+   * header of pushHeaderSize bytes, see pushHeaderSize, and is released chunk by chunk in live mode, see ReleaseChunks.
+   *
+   * \param socket the socket of the subscribed client.
+   * \param from the address of the subscribed client.
+   */
+  void PushNextSegment (Ptr<Socket> socket, const Address & from);
+
+  /**
+   * \brief Send the push header of the current segment to the client.
+   *
+   * \param socket the socket of the subscribed client.
+   * \param from the address of the subscribed client.
+   * \return the number of bytes sent.
+   */
+  int SendPushHeader (Ptr<Socket> socket, const Address & from);
+
+  /**
+   * \brief Read the segment sizes of all representations from m_segmentSizeFilePath, in the format the clients read.
+   *
+   * \return false if the file could not be read.
+   */
+  bool ReadSegmentSizes ();
+
+  /**
+   * \brief Send the hint record to the client as the first bytes of a segment response.
+   *
+   * The record contains the number of currently connected clients, the server's estimate of the fair share
+   * of bandwidth per downloading client and the aggregate egress rate of the most recent measurement window,
+   * see serverHints. The record is only sent if the segment is at least serverHintsSize bytes long.
+   *
+   * \param socket the socket of the client the hints are sent to.
+   * \return the number of bytes sent.
+   */
+  int SendHints (Ptr<Socket> socket);
+
+  /**
+   * \brief Account bytes sent to any client for the load statistics and the egress rate estimation.
+   *
+   * Once a measurement window of m_hintWindow has passed, the egress rate is updated and a new window is started.
+   *
+   * \param bytes the number of bytes that were just sent.
+   */
+  void UpdateEgressRate (uint32_t bytes);
+
   uint16_t m_port; //!< Port on which we listen for incoming packets.
   Ptr<Socket> m_socket; //!< IPv4 Socket
   Ptr<Socket> m_socket6; //!< IPv6 Socket
   std::map <Address, callbackData> m_callbackData; //!< With this it is possible to access the currentTxBytes, the packetSizeToReturn and the send boolean through the from value of the client.
   std::vector<Address> m_connectedClients; //!< Vector which holds the list of currently connected clients.
+  bool m_sendHints; //!< True if the server piggybacks hints on every segment response
+  DataRate m_hintCapacity; //!< Capacity of the bottleneck shared by the clients, used for the fair share estimation. If 0, the measured egress rate is used instead
+  Time m_hintWindow; //!< Duration of the window over which the egress rate is measured
+  uint32_t m_activeDownloads; //!< Number of clients whose segment is currently being sent
+  uint64_t m_windowBytes; //!< Bytes sent during the current egress rate measurement window
+  int64_t m_windowStart; //!< Start of the current egress rate measurement window in microseconds
+  double m_egressRate; //!< Egress rate in bits per second measured during the last completed window
+  uint32_t m_peakConnectedClients; //!< Maximum number of clients connected at the same time
+  uint64_t m_totalConnections; //!< Number of connections accepted
+  uint64_t m_requests; //!< Number of segment requests received
+  uint64_t m_bytesSent; //!< Number of bytes sent to clients
+  int64_t m_firstRequest; //!< Point in time in microseconds when the first request was received
+  int64_t m_lastSend; //!< Point in time in microseconds when data was sent the last time
+  std::string m_segmentSizeFilePath; //!< The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes, needed for push mode
+  std::vector < std::vector<int64_t > > m_segmentSizes; //!< Segment sizes of every representation, read when the first client subscribes to push
 
 
 };
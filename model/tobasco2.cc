@@ -17,12 +17,75 @@
  */
 
 #include "tobasco2.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("TobascoAlgorithm");
 
 NS_OBJECT_ENSURE_REGISTERED (TobascoAlgorithm);
+NS_ADAPTATION_ALGORITHM_REGISTER (TobascoAlgorithm, "tobasco");
+
+TypeId
+TobascoAlgorithm::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TobascoAlgorithm")
+    .SetParent<AdaptationAlgorithm> ()
+    .SetGroupName ("Applications")
+    .AddAttribute ("A1",
+                   "Fast start continues while the bitrate of the last representation is at most A1 times the average throughput",
+                   DoubleValue (0.75),
+                   MakeDoubleAccessor (&TobascoAlgorithm::m_a1),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("A2",
+                   "During fast start below BMin, switch up if the next higher bitrate is at most A2 times the average throughput",
+                   DoubleValue (0.33),
+                   MakeDoubleAccessor (&TobascoAlgorithm::m_a2),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("A3",
+                   "During fast start below BLow, switch up if the next higher bitrate is at most A3 times the average throughput",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&TobascoAlgorithm::m_a3),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("A4",
+                   "During fast start above BLow, switch up if the next higher bitrate is at most A4 times the average throughput",
+                   DoubleValue (0.75),
+                   MakeDoubleAccessor (&TobascoAlgorithm::m_a4),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("A5",
+                   "After fast start above BLow, switch up if the next higher bitrate is below A5 times the average throughput, else delay the download",
+                   DoubleValue (0.9),
+                   MakeDoubleAccessor (&TobascoAlgorithm::m_a5),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("BMin",
+                   "The minimum buffer level in microseconds",
+                   IntegerValue (5000000),
+                   MakeIntegerAccessor (&TobascoAlgorithm::m_bMin),
+                   MakeIntegerChecker<int64_t> (0))
+    .AddAttribute ("BLow",
+                   "The low buffer level in microseconds",
+                   IntegerValue (20000000),
+                   MakeIntegerAccessor (&TobascoAlgorithm::m_bLow),
+                   MakeIntegerChecker<int64_t> (0))
+    .AddAttribute ("BHigh",
+                   "The high buffer level in microseconds, the optimal buffer level is halfway between BLow and BHigh",
+                   IntegerValue (40000000),
+                   MakeIntegerAccessor (&TobascoAlgorithm::m_bHigh),
+                   MakeIntegerChecker<int64_t> (0))
+    .AddAttribute ("DeltaBeta",
+                   "Fast start continues while the last two downloads finished less than DeltaBeta (at least a segment duration) microseconds apart",
+                   IntegerValue (1000000),
+                   MakeIntegerAccessor (&TobascoAlgorithm::m_deltaBeta),
+                   MakeIntegerChecker<int64_t> (0))
+    .AddAttribute ("DeltaTime",
+                   "The interval in microseconds the average throughput is computed over",
+                   IntegerValue (10000000),
+                   MakeIntegerAccessor (&TobascoAlgorithm::m_deltaTime),
+                   MakeIntegerChecker<int64_t> (1))
+  ;
+  return tid;
+}
 
 TobascoAlgorithm::TobascoAlgorithm (  const videoData &videoData,
                                       const playbackData & playbackData,
@@ -37,7 +100,7 @@ TobascoAlgorithm::TobascoAlgorithm (  const videoData &videoData,
   m_bMin (5000000),
   m_bLow (20000000),
   m_bHigh (40000000),
-  m_bOpt ((int64_t)(0.5 * (m_bLow + m_bHigh))),
+  m_bOpt (0),
   m_deltaBeta (1000000),
   m_deltaTime (10000000),
   m_highestRepIndex (videoData.averageBitrate.size () - 1)
@@ -47,6 +110,13 @@ TobascoAlgorithm::TobascoAlgorithm (  const videoData &videoData,
   NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be >= 0");
 }
 
+void
+TobascoAlgorithm::NotifyConstructionCompleted (void)
+{
+  m_bOpt = (int64_t)(0.5 * (m_bLow + m_bHigh));
+  AdaptationAlgorithm::NotifyConstructionCompleted ();
+}
+
 algorithmReply
 TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
 {
@@ -57,7 +127,7 @@ TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
   // we use timeFactor, to divide the absolute size of a segment that is given in bits with the duration of a
   // segment in seconds, so that we get bitrate per seconds
   double timeFactor = m_videoData.segmentDuration / 1000000;
-  const int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  const int64_t timeNow = Now ();
   int64_t bufferNow = 0;
   // for the first segment the algorithm returns the lowest index 0 by definition, so we directly jump to the return part
   if (segmentCounter != 0)
@@ -122,16 +192,17 @@ TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
             }
           else if (bufferNow < m_bLow)
             {
-              double lastSegmentThroughput = (8.0 * m_videoData.segmentSize.at (m_lastRepIndex).at (segmentCounter - 1))
-                / ((double)(m_throughput.transmissionEnd.at (segmentCounter - 1) - m_throughput.transmissionStart.at (segmentCounter - 1)) / 1000000.0);
+              int64_t lastSegmentIndex = m_playbackData.firstSegmentIndex + segmentCounter - 1;
+              double lastSegmentThroughput = (8.0 * m_throughput.bytesReceived.at (segmentCounter - 1))
+                / ((double)(m_throughput.transmissionEnd.at (segmentCounter - 1) - m_throughput.transmissionStart.at (segmentCounter - 1) - m_throughput.transmissionIdle.at (segmentCounter - 1)) / 1000000.0);
 
               if ((m_lastRepIndex != 0)
-                  && ((8.0 * m_videoData.segmentSize.at (m_lastRepIndex).at (segmentCounter - 1)) / timeFactor >= lastSegmentThroughput))
+                  && ((8.0 * m_videoData.segmentSize.at (m_lastRepIndex).at (lastSegmentIndex)) / timeFactor >= lastSegmentThroughput))
                 {
                   decisionCase = 5;
                   for (int i = m_highestRepIndex; i >= 0; i--)
                     {
-                      if ((8.0 * m_videoData.segmentSize.at (i).at (segmentCounter - 1)) / timeFactor >= lastSegmentThroughput)
+                      if ((8.0 * m_videoData.segmentSize.at (i).at (lastSegmentIndex)) / timeFactor >= lastSegmentThroughput)
                         {
                           continue;
                         }
@@ -264,7 +335,7 @@ TobascoAlgorithm::AverageSegmentThroughput (int64_t t_1, int64_t t_2)
     {
       lengthOfInterval = m_throughput.transmissionEnd.at (index) - t_1;
       sumThroughput += (m_videoData.averageBitrate.at (m_playbackData.playbackIndex.at (index)) * ((m_throughput.transmissionEnd.at (index) - t_1)
-                                                                                                   / (m_throughput.transmissionEnd.at (index) - m_throughput.transmissionRequested.at (index)))) * lengthOfInterval;
+                                                                                                   / (m_throughput.transmissionEnd.at (index) - m_throughput.transmissionRequested.at (index) - m_throughput.transmissionIdle.at (index)))) * lengthOfInterval;
       transmissionTime += lengthOfInterval;
       index++;
       if (index >= m_throughput.transmissionEnd.size ())
@@ -275,7 +346,7 @@ TobascoAlgorithm::AverageSegmentThroughput (int64_t t_1, int64_t t_2)
   // Compute the average download-time of all the fully completed segment downloads during [t_1, t_2].
   while (m_throughput.transmissionEnd.at (index) <= t_2)
     {
-      lengthOfInterval = m_throughput.transmissionEnd.at (index) - m_throughput.transmissionRequested.at (index);
+      lengthOfInterval = m_throughput.transmissionEnd.at (index) - m_throughput.transmissionRequested.at (index) - m_throughput.transmissionIdle.at (index);
       sumThroughput += ((m_videoData.averageBitrate.at (m_playbackData.playbackIndex.at (index)) * m_videoData.segmentDuration)
                         / lengthOfInterval)  * lengthOfInterval;
       transmissionTime += lengthOfInterval;
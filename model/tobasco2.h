@@ -30,6 +30,12 @@ namespace ns3 {
 class TobascoAlgorithm : public AdaptationAlgorithm
 {
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
   TobascoAlgorithm (  const videoData &videoData,
                       const playbackData & playbackData,
                       const bufferData & bufferData,
@@ -53,17 +59,24 @@ private:
    */
   bool MinimumBufferLevelObserved ();
 
-  const double m_a1;
-  const double m_a2;
-  const double m_a3;
-  const double m_a4;
-  const double m_a5;
-  const int64_t m_bMin;
-  const int64_t m_bLow;
-  const int64_t m_bHigh;
-  const int64_t m_bOpt;
-  const int64_t m_deltaBeta;
-  const int64_t m_deltaTime;
+protected:
+  /**
+   * \brief Derive the optimal buffer level once the attributes are set.
+   */
+  virtual void NotifyConstructionCompleted (void);
+
+private:
+  double m_a1;
+  double m_a2;
+  double m_a3;
+  double m_a4;
+  double m_a5;
+  int64_t m_bMin;
+  int64_t m_bLow;
+  int64_t m_bHigh;
+  int64_t m_bOpt;
+  int64_t m_deltaBeta;
+  int64_t m_deltaTime;
   const int64_t m_highestRepIndex;
   int64_t m_lastRepIndex;
   bool m_runningFastStart;
@@ -0,0 +1,255 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "video-catalog.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <numeric>
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("VideoCatalog");
+
+NS_OBJECT_ENSURE_REGISTERED (VideoCatalog);
+
+/**
+ * \brief The manifests read so far, by segment size file, segment quality file and segment duration.
+ *
+ * The map never moves its elements, so the manifests can be referenced by the clients for the whole simulation.
+ */
+static std::map<std::pair<std::pair<std::string, std::string>, int64_t>, videoData> &
+Manifests (void)
+{
+  static std::map<std::pair<std::pair<std::string, std::string>, int64_t>, videoData> manifests;
+  return manifests;
+}
+
+TypeId
+VideoCatalog::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VideoCatalog")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<VideoCatalog> ()
+    .AddAttribute ("CatalogFilePath",
+                   "The relative path (from ns-3.x directory) to the catalog file, one title per line: segment size file and optionally segment quality file, by decreasing popularity",
+                   StringValue (""),
+                   MakeStringAccessor (&VideoCatalog::m_catalogFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("AssignmentFilePath",
+                   "The relative path (from ns-3.x directory) to a file with the title index of every client, one per line in order of the client ids. If empty, titles are drawn by popularity",
+                   StringValue (""),
+                   MakeStringAccessor (&VideoCatalog::m_assignmentFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("ZipfExponent",
+                   "The exponent of the Zipf distribution of the popularity of the titles",
+                   DoubleValue (0.8),
+                   MakeDoubleAccessor (&VideoCatalog::m_zipfExponent),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+VideoCatalog::VideoCatalog ()
+{
+  NS_LOG_FUNCTION (this);
+  m_popularity = CreateObject<ZipfRandomVariable> ();
+}
+
+VideoCatalog::~VideoCatalog ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+VideoCatalog::NotifyConstructionCompleted (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_catalogFilePath.empty ())
+    {
+      std::ifstream catalog (m_catalogFilePath.c_str ());
+      NS_ABORT_MSG_IF (!catalog, "Couldn't open the catalog " << m_catalogFilePath);
+      std::string line;
+      while (std::getline (catalog, line))
+        {
+          std::istringstream fields (line);
+          std::string segmentSizeFile, segmentQualityFile;
+          if (fields >> segmentSizeFile)
+            {
+              fields >> segmentQualityFile;
+              AddTitle (segmentSizeFile, segmentQualityFile);
+            }
+        }
+    }
+  if (!m_assignmentFilePath.empty ())
+    {
+      std::ifstream assignment (m_assignmentFilePath.c_str ());
+      NS_ABORT_MSG_IF (!assignment, "Couldn't open the title assignment " << m_assignmentFilePath);
+      uint32_t title;
+      while (assignment >> title)
+        {
+          m_assignment.push_back (title);
+        }
+      NS_ABORT_MSG_IF (m_assignment.empty (), "The title assignment " << m_assignmentFilePath << " is empty");
+    }
+  Object::NotifyConstructionCompleted ();
+}
+
+uint32_t
+VideoCatalog::AddTitle (std::string segmentSizeFile, std::string segmentQualityFile)
+{
+  NS_LOG_FUNCTION (this << segmentSizeFile << segmentQualityFile);
+  m_segmentSizeFiles.push_back (segmentSizeFile);
+  m_segmentQualityFiles.push_back (segmentQualityFile);
+  m_viewers.push_back (0);
+  return m_segmentSizeFiles.size () - 1;
+}
+
+uint32_t
+VideoCatalog::GetN (void) const
+{
+  return m_segmentSizeFiles.size ();
+}
+
+std::string
+VideoCatalog::GetSegmentSizeFilePath (uint32_t title) const
+{
+  return m_segmentSizeFiles.at (title);
+}
+
+std::string
+VideoCatalog::GetSegmentQualityFilePath (uint32_t title) const
+{
+  return m_segmentQualityFiles.at (title);
+}
+
+uint32_t
+VideoCatalog::AssignTitle (uint32_t clientId)
+{
+  NS_LOG_FUNCTION (this << clientId);
+  NS_ABORT_MSG_IF (m_segmentSizeFiles.empty (), "The catalog holds no titles");
+  uint32_t title;
+  if (!m_assignment.empty ())
+    {
+      // clients beyond the end of the assignment start over at its beginning
+      title = m_assignment.at (clientId % m_assignment.size ());
+      NS_ABORT_MSG_IF (title >= m_segmentSizeFiles.size (), "Title " << title << " assigned to client " << clientId << " is not in the catalog");
+    }
+  else
+    {
+      m_popularity->SetAttribute ("N", IntegerValue (m_segmentSizeFiles.size ()));
+      m_popularity->SetAttribute ("Alpha", DoubleValue (m_zipfExponent));
+      // the ranks drawn start at 1
+      title = m_popularity->GetInteger () - 1;
+    }
+  m_viewers.at (title)++;
+  return title;
+}
+
+uint32_t
+VideoCatalog::GetViewers (uint32_t title) const
+{
+  return m_viewers.at (title);
+}
+
+int64_t
+VideoCatalog::AssignStreams (int64_t stream)
+{
+  m_popularity->SetStream (stream);
+  return 1;
+}
+
+const videoData *
+VideoCatalog::GetManifest (std::string segmentSizeFile, std::string segmentQualityFile, int64_t segmentDuration)
+{
+  NS_LOG_FUNCTION (segmentSizeFile << segmentQualityFile << segmentDuration);
+  std::pair<std::pair<std::string, std::string>, int64_t> key (std::make_pair (segmentSizeFile, segmentQualityFile), segmentDuration);
+  std::map<std::pair<std::pair<std::string, std::string>, int64_t>, videoData>::iterator it = Manifests ().find (key);
+  if (it != Manifests ().end ())
+    {
+      return &it->second;
+    }
+
+  videoData video;
+  video.segmentDuration = segmentDuration;
+  std::ifstream sizeFile (segmentSizeFile.c_str ());
+  if (!sizeFile)
+    {
+      return 0;
+    }
+  // one line of segment sizes in bytes per representation level
+  std::string temp;
+  int64_t averageByteSizeTemp = 0;
+  while (std::getline (sizeFile, temp))
+    {
+      if (temp.empty ())
+        {
+          break;
+        }
+      std::istringstream buffer (temp);
+      std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
+                                 std::istream_iterator<int64_t>());
+      video.segmentSize.push_back (line);
+      averageByteSizeTemp = (int64_t) std::accumulate ( line.begin (), line.end (), 0.0) / line.size ();
+      video.averageBitrate.push_back ((8.0 * averageByteSizeTemp) / (video.segmentDuration / 1000000.0));
+    }
+  NS_ABORT_MSG_IF (video.segmentSize.empty (), "No segment sizes read from file.");
+
+  if (!segmentQualityFile.empty ())
+    {
+      // the perceptual quality, e.g. VMAF or SSIM, of every segment in the layout of the segment sizes
+      std::ifstream qualityFile (segmentQualityFile.c_str ());
+      if (!qualityFile)
+        {
+          return 0;
+        }
+      while (std::getline (qualityFile, temp))
+        {
+          if (temp.empty ())
+            {
+              break;
+            }
+          std::istringstream buffer (temp);
+          std::vector<double> line ((std::istream_iterator<double> (buffer)),
+                                    std::istream_iterator<double>());
+          video.segmentQuality.push_back (line);
+        }
+      NS_ABORT_MSG_IF (video.segmentQuality.size () != video.segmentSize.size (), "The segment quality file does not hold one line per representation.");
+      for (uint i = 0; i < video.segmentQuality.size (); i++)
+        {
+          NS_ABORT_MSG_IF (video.segmentQuality.at (i).size () != video.segmentSize.at (i).size (), "The segment quality file does not hold one value per segment.");
+        }
+    }
+
+  NS_LOG_INFO ("Read manifest " << segmentSizeFile << " with " << video.segmentSize.size () << " representations");
+  return &(Manifests () [key] = video);
+}
+
+uint32_t
+VideoCatalog::GetLoadedManifests (void)
+{
+  return Manifests ().size ();
+}
+
+} // namespace ns3
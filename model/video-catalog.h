@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef VIDEO_CATALOG_H
+#define VIDEO_CATALOG_H
+
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+#include "tcp-stream-interface.h"
+#include <stdint.h>
+#include <vector>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief A catalog of videos, each one described by a manifest, and the popularity of the videos.
+ *
+ * The catalog file holds one video (title) per line: the path to its segment size file and, optionally, the
+ * path to its segment quality file. The titles are listed by decreasing popularity; every client is assigned
+ * a title drawn from a Zipf distribution over the titles, or the title listed for it in an assignment file.
+ *
+ * Manifests are read once per file and segment duration and shared by all clients streaming the same title,
+ * see GetManifest.
+ */
+class VideoCatalog : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  VideoCatalog ();
+  virtual ~VideoCatalog ();
+
+  /**
+   * \brief Add a title to the end of the catalog, i.e. as the least popular one so far.
+   *
+   * \param segmentSizeFile the relative path (from ns-3.x directory) to the segment size file of the title
+   * \param segmentQualityFile the relative path to the segment quality file of the title, empty if not provided
+   * \return the index of the title, which is the video id of its clients
+   */
+  uint32_t AddTitle (std::string segmentSizeFile, std::string segmentQualityFile = "");
+
+  uint32_t GetN (void) const; //!< \return the number of titles in the catalog
+  std::string GetSegmentSizeFilePath (uint32_t title) const; //!< \return the segment size file of a title
+  std::string GetSegmentQualityFilePath (uint32_t title) const; //!< \return the segment quality file of a title, empty if not provided
+
+  /**
+   * \brief Choose the title a client streams.
+   *
+   * \param clientId the id of the client
+   * \return the index of the title
+   */
+  uint32_t AssignTitle (uint32_t clientId);
+
+  /**
+   * \param title the index of a title
+   * \return the number of clients assigned to the title so far
+   */
+  uint32_t GetViewers (uint32_t title) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variable used by this catalog.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this catalog
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Get the manifest of a video, reading it on first use only.
+   *
+   * \param segmentSizeFile the relative path (from ns-3.x directory) to the segment size file, one line of segment
+   *        sizes in bytes per representation
+   * \param segmentQualityFile the relative path to the segment quality file in the same layout, empty if not provided
+   * \param segmentDuration the duration of a segment in microseconds
+   * \return the manifest, shared by all callers asking for the same files and segment duration, 0 if a file could not be read
+   */
+  static const videoData * GetManifest (std::string segmentSizeFile, std::string segmentQualityFile, int64_t segmentDuration);
+
+  /**
+   * \return the number of distinct manifests read so far
+   */
+  static uint32_t GetLoadedManifests (void);
+
+protected:
+  virtual void NotifyConstructionCompleted (void);
+
+private:
+  std::string m_catalogFilePath; //!< The relative path (from ns-3.x directory) to the catalog file
+  std::string m_assignmentFilePath; //!< The relative path to the file with the title of every client, empty for Zipf draws
+  double m_zipfExponent; //!< The exponent of the Zipf distribution of the popularity of the titles
+  std::vector<std::string> m_segmentSizeFiles; //!< The segment size file of every title
+  std::vector<std::string> m_segmentQualityFiles; //!< The segment quality file of every title
+  std::vector<uint32_t> m_assignment; //!< The title of every client, read from the assignment file
+  std::vector<uint32_t> m_viewers; //!< Number of clients assigned to every title
+  Ptr<ZipfRandomVariable> m_popularity; //!< Draws the popularity rank of the title of a client
+};
+
+} // namespace ns3
+
+#endif /* VIDEO_CATALOG_H */
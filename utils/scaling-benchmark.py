@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+# -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation;
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+"""Runs the tcp-stream example for every combination of algorithm, number of
+clients and topology and collects what every run cost into one table.
+
+Run it from the ns-3.x directory, e.g.
+
+    python3 contrib/dash/utils/scaling-benchmark.py --clients 1,10,100 --algorithms panda,bola
+
+Per run, the table holds the wall clock time and simulated seconds per second
+and the peak resident set size (from the runtimeLog the example writes), the
+events scheduled by all clients (from their sessionLogs) and the bytes of log
+output the run produced.
+"""
+
+import argparse
+import glob
+import os
+import resource
+import subprocess
+import sys
+
+LOG_DIRECTORY = 'dash-log-files'
+TOPOLOGIES = ['wifi', 'p2p']
+
+
+def run_prefix(algorithm, clients, simulation_id):
+    return os.path.join(LOG_DIRECTORY, algorithm, str(clients), 'sim%d_' % simulation_id)
+
+
+def read_table(path):
+    """Returns the lines of a whitespace separated log file without its header."""
+    with open(path) as log:
+        return [line.split() for line in log.readlines()[1:] if line.strip()]
+
+
+def collect(algorithm, clients, simulation_id):
+    prefix = run_prefix(algorithm, clients, simulation_id)
+    runtime = read_table(prefix + 'runtimeLog.txt')[0]
+    events = 0
+    for session_log in glob.glob(prefix + 'cl*_sessionLog.txt'):
+        for line in read_table(session_log):
+            events += int(line[5])
+    log_bytes = sum(os.path.getsize(path) for path in glob.glob(prefix + '*'))
+    return {
+        'wall_clock_s': float(runtime[1]),
+        'simulated_s': float(runtime[2]),
+        'simulated_s_per_s': float(runtime[3]),
+        'scheduled_events': events,
+        'peak_rss_kb': int(runtime[4]),
+        'log_bytes': log_bytes,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--algorithms', default='tobasco,festive,panda,bola,mpc',
+                        help='comma separated adaptation algorithms')
+    parser.add_argument('--clients', default='1,10,100,1000,5000',
+                        help='comma separated numbers of clients')
+    parser.add_argument('--topologies', default=','.join(TOPOLOGIES),
+                        help='comma separated topologies of the tcp-stream example: wifi and/or p2p')
+    parser.add_argument('--segmentDuration', default='2000000', help='segment duration in microseconds')
+    parser.add_argument('--segmentSizeFile', default='contrib/dash/segmentSizes.txt',
+                        help='segment size file, relative to the ns-3.x directory')
+    parser.add_argument('--simulationId', type=int, default=1000,
+                        help='simulation id of the first run, every topology uses its own id')
+    parser.add_argument('--timeout', type=float, default=None, help='seconds after which a run is aborted')
+    parser.add_argument('--output', default=os.path.join(LOG_DIRECTORY, 'scalingBenchmark.csv'),
+                        help='the summary table')
+    parser.add_argument('extra', nargs='*', help='further arguments passed to tcp-stream, e.g. --push=true')
+    args = parser.parse_args()
+
+    topologies = args.topologies.split(',')
+    for topology in topologies:
+        if topology not in TOPOLOGIES:
+            sys.exit('unknown topology ' + topology)
+
+    subprocess.check_call(['./waf', 'build'])
+
+    # every client keeps its log files open, the runs inherit the highest limit of open files allowed
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    if soft != hard:
+        resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+
+    columns = ['algorithm', 'topology', 'clients', 'wall_clock_s', 'simulated_s', 'simulated_s_per_s',
+               'scheduled_events', 'peak_rss_kb', 'log_bytes']
+    rows = []
+    for algorithm in args.algorithms.split(','):
+        for clients in [int(c) for c in args.clients.split(',')]:
+            for topology in topologies:
+                simulation_id = args.simulationId + TOPOLOGIES.index(topology)
+                command = ('tcp-stream --simulationId=%d --numberOfClients=%d --adaptationAlgo=%s '
+                           '--segmentDuration=%s --segmentSizeFile=%s --topology=%s %s'
+                           % (simulation_id, clients, algorithm, args.segmentDuration,
+                              args.segmentSizeFile, topology, ' '.join(args.extra)))
+                print('running ' + command, flush=True)
+                try:
+                    subprocess.check_call(['./waf', '--run', command], timeout=args.timeout,
+                                          stdout=subprocess.DEVNULL)
+                except (subprocess.CalledProcessError, subprocess.TimeoutExpired) as error:
+                    print('  failed: %s' % error, flush=True)
+                    continue
+                row = collect(algorithm, clients, simulation_id)
+                row.update({'algorithm': algorithm, 'topology': topology, 'clients': clients})
+                rows.append(row)
+
+    with open(args.output, 'w') as output:
+        output.write(','.join(columns) + '\n')
+        for row in rows:
+            output.write(','.join(str(row[c]) for c in columns) + '\n')
+
+    widths = [max(len(c), 12) for c in columns]
+    print(' '.join(c.rjust(w) for c, w in zip(columns, widths)))
+    for row in rows:
+        print(' '.join(str(row[c]).rjust(w) for c, w in zip(columns, widths)))
+    print('summary written to ' + args.output)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+# -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation;
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+"""Runs the tcp-stream example for every point of a parameter grid, in
+parallel on all local cores.
+
+The ns-3 simulator is a per-process singleton, so every run is a process of
+its own; at most --jobs of them run at a time. Run it from the ns-3.x
+directory, e.g.
+
+    python3 contrib/dash/utils/sweep.py --algorithms panda,bola --clients 5,10 --seeds 1-20
+
+Further parameters of tcp-stream are given as a JSON file mapping each
+parameter to a list of values (--grid), or as fixed values (--set push=true).
+
+Every run is identified by a hash of its configuration. Completed runs are
+appended to dash-log-files/sweepManifest.jsonl, and runs whose hash is in the
+manifest already are skipped, so an interrupted or extended sweep only runs
+what is missing. Runs that crash or time out are retried. The output of every
+run is kept in dash-log-files/sweep/<hash>.log.
+"""
+
+import argparse
+import concurrent.futures
+import hashlib
+import itertools
+import json
+import os
+import subprocess
+import sys
+import threading
+import time
+
+LOG_DIRECTORY = 'dash-log-files'
+MANIFEST = os.path.join(LOG_DIRECTORY, 'sweepManifest.jsonl')
+RUN_LOG_DIRECTORY = os.path.join(LOG_DIRECTORY, 'sweep')
+
+
+def parse_range(text):
+    """Parses "1,2,5-8" into [1, 2, 5, 6, 7, 8]."""
+    values = []
+    for part in text.split(','):
+        if '-' in part:
+            first, last = part.split('-')
+            values.extend(range(int(first), int(last) + 1))
+        else:
+            values.append(int(part))
+    return values
+
+
+def configuration_hash(program, config):
+    text = json.dumps({'program': program, 'config': config}, sort_keys=True)
+    return hashlib.sha1(text.encode()).hexdigest()[:16]
+
+
+def log_prefix(config):
+    """The prefix of the log files of a run, runs sharing it would overwrite each other's logs."""
+    return os.path.join(LOG_DIRECTORY, str(config['adaptationAlgo']), str(config['numberOfClients']),
+                        'sim%s_' % config['simulationId'])
+
+
+def find_program(program):
+    """Builds ns-3 once and returns the path of the example's executable."""
+    output = subprocess.check_output(['./waf', '--run', program, '--command-template=echo %s'],
+                                     universal_newlines=True)
+    for line in reversed(output.splitlines()):
+        if os.path.isfile(line.strip()):
+            return os.path.abspath(line.strip())
+    sys.exit('could not find the executable of ' + program)
+
+
+def read_manifest():
+    done = {}
+    if os.path.exists(MANIFEST):
+        with open(MANIFEST) as manifest:
+            for line in manifest:
+                if line.strip():
+                    entry = json.loads(line)
+                    done[entry['hash']] = entry
+    return done
+
+
+class Sweep:
+    def __init__(self, executable, args):
+        self.executable = executable
+        self.args = args
+        self.lock = threading.Lock()
+        self.env = dict(os.environ)
+        library_path = os.path.abspath(os.path.join('build', 'lib'))
+        self.env['LD_LIBRARY_PATH'] = library_path + os.pathsep + self.env.get('LD_LIBRARY_PATH', '')
+
+    def run(self, key, config):
+        command = [self.executable] + ['--%s=%s' % (name, value) for name, value in sorted(config.items())]
+        run_log = os.path.join(RUN_LOG_DIRECTORY, key + '.log')
+        for attempt in range(1, self.args.retries + 2):
+            start = time.time()
+            with open(run_log, 'w') as output:
+                try:
+                    returncode = subprocess.call(command, stdout=output, stderr=subprocess.STDOUT,
+                                                 env=self.env, timeout=self.args.timeout)
+                except subprocess.TimeoutExpired:
+                    returncode = 'timeout'
+            if returncode == 0:
+                entry = {'hash': key, 'config': config, 'logPrefix': log_prefix(config),
+                         'attempts': attempt, 'wallClock': round(time.time() - start, 3),
+                         'finished': time.strftime('%Y-%m-%dT%H:%M:%S')}
+                with self.lock:
+                    with open(MANIFEST, 'a') as manifest:
+                        manifest.write(json.dumps(entry, sort_keys=True) + '\n')
+                return True
+            with self.lock:
+                print('  %s failed (%s), attempt %d of %d' % (key, returncode, attempt, self.args.retries + 1),
+                      flush=True)
+        return False
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--program', default='tcp-stream', help='the ns-3 program to run')
+    parser.add_argument('--algorithms', default='tobasco', help='comma separated adaptation algorithms')
+    parser.add_argument('--clients', default='1', help='numbers of clients, e.g. 1,5,10-12')
+    parser.add_argument('--seeds', default='1', help='simulation ids, e.g. 1-20')
+    parser.add_argument('--segmentDuration', default='2000000', help='segment duration in microseconds')
+    parser.add_argument('--segmentSizeFile', default='contrib/dash/segmentSizes.txt',
+                        help='segment size file, relative to the ns-3.x directory')
+    parser.add_argument('--grid', help='JSON file mapping further parameters of the program to lists of values')
+    parser.add_argument('--set', action='append', default=[], metavar='NAME=VALUE',
+                        help='a further parameter with a fixed value, may be repeated')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count(), help='number of runs at a time')
+    parser.add_argument('--retries', type=int, default=2, help='how often a crashed run is repeated')
+    parser.add_argument('--timeout', type=float, default=None, help='seconds after which a run counts as crashed')
+    parser.add_argument('--dry-run', action='store_true', help='only list the runs that would be started')
+    args = parser.parse_args()
+
+    grid = {
+        'adaptationAlgo': args.algorithms.split(','),
+        'numberOfClients': parse_range(args.clients),
+        'simulationId': parse_range(args.seeds),
+        'segmentDuration': [args.segmentDuration],
+        'segmentSizeFile': [args.segmentSizeFile],
+    }
+    if args.grid:
+        with open(args.grid) as grid_file:
+            for name, values in json.load(grid_file).items():
+                grid[name] = values if isinstance(values, list) else [values]
+    for assignment in args.set:
+        name, value = assignment.split('=', 1)
+        grid[name] = [value]
+
+    names = sorted(grid)
+    configs = [dict(zip(names, values)) for values in itertools.product(*(grid[name] for name in names))]
+
+    # the log files are named after algorithm, number of clients and simulation id only
+    prefixes = {}
+    for config in configs:
+        prefix = log_prefix(config)
+        if prefix in prefixes:
+            sys.exit('%s and %s write to the same log files %s*, vary the simulation id instead'
+                     % (prefixes[prefix], config, prefix))
+        prefixes[prefix] = config
+
+    done = read_manifest()
+    pending = []
+    for config in configs:
+        key = configuration_hash(args.program, config)
+        if key not in done:
+            pending.append((key, config))
+    print('%d runs, %d done already, %d to run' % (len(configs), len(configs) - len(pending), len(pending)))
+    if args.dry_run:
+        for key, config in pending:
+            print(key, json.dumps(config, sort_keys=True))
+        return
+    if not pending:
+        return
+
+    # create all log directories up front, so parallel runs do not race for them
+    os.makedirs(RUN_LOG_DIRECTORY, exist_ok=True)
+    for key, config in pending:
+        os.makedirs(os.path.dirname(log_prefix(config)), exist_ok=True)
+
+    sweep = Sweep(find_program(args.program), args)
+    failed = 0
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = {pool.submit(sweep.run, key, config): key for key, config in pending}
+        for number, future in enumerate(concurrent.futures.as_completed(futures), 1):
+            if not future.result():
+                failed += 1
+            print('[%d/%d] %s %s' % (number, len(pending), futures[future], 'done' if future.result() else 'FAILED'),
+                  flush=True)
+    print('%d runs completed, %d failed, manifest in %s' % (len(pending) - failed, failed, MANIFEST))
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()